@@ -8,18 +8,29 @@ this hpp implements aggregated logarithmic size Bulletproofs
 #ifndef __BULLET__
 #define __BULLET__
 #include "innerproduct_proof.hpp" 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const string BULLET_SEED = "PGC.bulletproofs"; // the default seed of the generators
 
 // define the structure of Bulletproofs
 struct Bullet_PP
 {
     size_t RANGE_LEN; 
     size_t LOG_RANGE_LEN; 
-    size_t AGG_NUM; // number of sub-argument (for now, we require m to be the power of 2)
+    size_t AGG_NUM; // number of sub-argument, any m >= 1
+
+    // RANGE_LEN <= 64 and AGG_NUM are arbitrary: the nm coordinates are padded to a power of 2 (Bullet_IP_len) 
+    // with coordinates of dummy zero values, so vec_g and vec_h hold that many generators 
 
     EC_POINT *g, *h;
     EC_POINT *u; // used for inside innerproduct statement
     vector<EC_POINT *> vec_g; 
     vector<EC_POINT *> vec_h; // the pp of innerproduct part    
+    string SEED; // u, vec_g and vec_h are hashed to the curve from SEED
+    PointVec_Table table; // optional fixed-base tables of g, h, u, vec_g, vec_h in this order (Bullet_PP_precompute)
 };
 
 struct Bullet_Instance
@@ -82,14 +93,31 @@ void Bullet_Proof_deserialize(Bullet_Proof &proof, ifstream &fin)
     InnerProduct_Proof_deserialize(proof.ip_proof, fin); 
 }
 
+/* 
+    the length of the inner product argument: nm rounded up to a power of 2, the padded coordinates are bits of 
+    dummy zero values with the public aL = 0, aR = -1 and sL = sR = 0 
+*/
+size_t Bullet_IP_len(size_t RANGE_LEN, size_t AGG_NUM)
+{
+    size_t IP_LEN = 1; 
+    while (IP_LEN < RANGE_LEN*AGG_NUM) IP_LEN = IP_LEN*2; 
+    return IP_LEN; 
+}
+
 void Bullet_PP_new(Bullet_PP &pp, size_t &RANGE_LEN, size_t &AGG_NUM)
 {
+    if (RANGE_LEN == 0 || RANGE_LEN > 64 || AGG_NUM == 0)
+    {
+        cout << "Bulletproofs require 1 <= RANGE_LEN <= 64 and AGG_NUM >= 1" << endl; 
+        exit(EXIT_FAILURE); 
+    }
     pp.g = EC_POINT_new(group);  
     pp.h = EC_POINT_new(group);
     pp.u = EC_POINT_new(group);  
 
-    pp.vec_g.resize(RANGE_LEN*AGG_NUM); ECP_vec_new(pp.vec_g); 
-    pp.vec_h.resize(RANGE_LEN*AGG_NUM); ECP_vec_new(pp.vec_h);  
+    pp.vec_g.resize(Bullet_IP_len(RANGE_LEN, AGG_NUM)); ECP_vec_new(pp.vec_g); 
+    pp.vec_h.resize(Bullet_IP_len(RANGE_LEN, AGG_NUM)); ECP_vec_new(pp.vec_h);  
+    pp.table.WINDOW_LEN = 0, pp.table.WINDOW_NUM = 0; 
 }
 
 void Bullet_PP_free(Bullet_PP &pp)
@@ -99,6 +127,7 @@ void Bullet_PP_free(Bullet_PP &pp)
     EC_POINT_free(pp.u); 
     ECP_vec_free(pp.vec_g); 
     ECP_vec_free(pp.vec_h); 
+    PointVec_Table_free(pp.table); 
 }
 
 void Bullet_Witness_new(Bullet_PP &pp, Bullet_Witness &witness)
@@ -150,92 +179,299 @@ void Bullet_Proof_free(Bullet_Proof &proof)
     InnerProduct_Proof_free(proof.ip_proof);
 }
 
-void Bullet_Setup(Bullet_PP &pp, size_t &RANGE_LEN, size_t &AGG_NUM)
+/* derive the pp from SEED: parties with the same (RANGE_LEN, AGG_NUM, SEED) get the same pp */
+void Bullet_Setup(Bullet_PP &pp, size_t &RANGE_LEN, size_t &AGG_NUM, string SEED = BULLET_SEED)
 {
     pp.RANGE_LEN = RANGE_LEN; 
-    pp.LOG_RANGE_LEN = log2(RANGE_LEN); 
+    pp.LOG_RANGE_LEN = ceil(log2(RANGE_LEN)); 
     pp.AGG_NUM = AGG_NUM; 
+    pp.SEED = SEED; 
  
     EC_POINT_copy(pp.g, generator); 
     Hash_ECP_to_ECP(pp.g, pp.h); 
-    ECP_random(pp.u);
+    Hash_to_Curve(pp.u, SEED + ".u", 0, bn_ctx); 
+    Hash_to_Curve_vec(pp.vec_g, SEED + ".vec_g"); 
+    Hash_to_Curve_vec(pp.vec_h, SEED + ".vec_h"); 
     //cout << "Bulletproof setup finished" << endl; 
 }
 
+/*
+    The pp file is laid out as 
+    [magic | RANGE_LEN | AGG_NUM | SEED_LEN | SEED | g, h, u, vec_g, vec_h | SHA256 of everything before]: 
+    the points are uncompressed, so loading needs no square roots, and the digest detects a damaged file. 
+    A file with planted generators (e.g. h = g^k) still passes the digest, so loading also checks every point 
+    against its derivation: g, h directly and u, vec_g, vec_h with Hash_to_Curve_check, which costs hashes and 
+    Jacobi symbols instead of square roots (about half of the time of deriving them). 
+*/
+const uint64_t BULLET_PP_MAGIC = 0x3130505042434750; // "PGCBPP01"
+const size_t BULLET_PP_POINT_LEN = 2*BN_LEN + 1;    // uncompressed EC point
+
+/* the size of the pp file of pp */
+size_t Bullet_PP_file_len(Bullet_PP &pp)
+{
+    return 4*sizeof(uint64_t) + pp.SEED.size() + (3 + 2*pp.vec_g.size())*BULLET_PP_POINT_LEN + HASH_OUTPUT_LEN; 
+}
 
-// statement C = g^r h^v and v \in [0, 2^n-1]
-void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witness, 
-                  string &transcript_str, Bullet_Proof &proof)
-{ 
-    auto start_time = chrono::steady_clock::now(); 
-    for (auto i = 0; i < instance.C.size(); i++){
-        transcript_str += ECP_ep2string(instance.C[i]); 
-    }
+/* save pp to pp_file (written to a temporary file and renamed, so that readers never see a partial file) */
+void Bullet_PP_serialize(Bullet_PP &pp, string pp_file)
+{
+    string buffer(Bullet_PP_file_len(pp), 0); 
+    unsigned char *p = reinterpret_cast<unsigned char *>(&buffer[0]); 
+    uint64_t header[4] = {BULLET_PP_MAGIC, pp.RANGE_LEN, pp.AGG_NUM, pp.SEED.size()}; 
+    memcpy(p, header, sizeof(header)); p += sizeof(header); 
+    memcpy(p, pp.SEED.data(), pp.SEED.size()); p += pp.SEED.size(); 
 
-    BIGNUM *temp_bn; 
-    size_t l = pp.RANGE_LEN * pp.AGG_NUM; // l = mn
+    vector<EC_POINT *> vec_A = {pp.g, pp.h, pp.u}; 
+    vec_A.insert(vec_A.end(), pp.vec_g.begin(), pp.vec_g.end()); 
+    vec_A.insert(vec_A.end(), pp.vec_h.begin(), pp.vec_h.end()); 
+    for(auto i = 0; i < vec_A.size(); i++)
+    {
+        EC_POINT_point2oct(group, vec_A[i], POINT_CONVERSION_UNCOMPRESSED, p, BULLET_PP_POINT_LEN, bn_ctx); 
+        p += BULLET_PP_POINT_LEN; 
+    }
+    SHA256(reinterpret_cast<unsigned char *>(&buffer[0]), buffer.size() - HASH_OUTPUT_LEN, p); 
 
-    vector<BIGNUM *> vec_aL(l); 
-    BN_vec_new(vec_aL); 
-    vector<BIGNUM *> vec_aR(l);
-    BN_vec_new(vec_aR); 
-    vector<BIGNUM *> vec_1_power(l); // vec_unary = 1^nm
-    BN_vec_new(vec_1_power);
-    for(auto i = 0; i < l; i++) BN_one(vec_1_power[i]); 
-   
-    for (auto i = 0; i < pp.AGG_NUM; i++)
+    string tmp_file = pp_file + ".tmp" + to_string(getpid()); 
+    ofstream fout(tmp_file, ios::binary); 
+    fout.write(buffer.data(), buffer.size()); 
+    fout.close(); 
+    if(!fout || rename(tmp_file.c_str(), pp_file.c_str()) != 0)
     {
-        for(auto j = 0; j < pp.RANGE_LEN; j++)
-        {
-            if(BN_parse_binary(witness.v[i], j) == 1){
-                BN_one(vec_aL[i*pp.RANGE_LEN + j]);  
-            }
-            else{
-                BN_zero(vec_aL[i*pp.RANGE_LEN + j]); 
-            } 
-        }
+        cout << pp_file << " write error" << endl; 
+        exit(EXIT_FAILURE); 
     }
+}
 
-    BN_vec_sub(vec_aR, vec_aL, vec_1_power); // Eq (42) -- aR = aL - 1^n
+/* 
+    map pp_file and load it into pp (allocated by Bullet_PP_new with RANGE_LEN, AGG_NUM): 
+    return false if the file is missing, damaged, made for other (RANGE_LEN, AGG_NUM, SEED), or holds points 
+    that are not derived from SEED
+*/
+bool Bullet_PP_deserialize(Bullet_PP &pp, size_t &RANGE_LEN, size_t &AGG_NUM, string pp_file, 
+                           string SEED = BULLET_SEED)
+{
+    pp.RANGE_LEN = RANGE_LEN; 
+    pp.LOG_RANGE_LEN = ceil(log2(RANGE_LEN)); 
+    pp.AGG_NUM = AGG_NUM; 
+    pp.SEED = SEED; 
 
-    // prepare vec_A and vec_a for multi-exponention (used hereafter)
-    vector<EC_POINT *> vec_A; 
-    vector<BIGNUM *> vec_a; 
+    int fd = open(pp_file.c_str(), O_RDONLY); 
+    if(fd < 0) return false; 
+    struct stat file_stat; 
+    if(fstat(fd, &file_stat) != 0 || size_t(file_stat.st_size) != Bullet_PP_file_len(pp))
+    {
+        close(fd); 
+        return false; 
+    }
+    size_t file_len = file_stat.st_size; 
+    void *base = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0); 
+    close(fd); 
+    if(base == MAP_FAILED) return false; 
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(base); 
+
+    bool VALID = true; 
+    uint64_t header[4]; 
+    memcpy(header, p, sizeof(header)); 
+    unsigned char digest[HASH_OUTPUT_LEN]; 
+    SHA256(p, file_len - HASH_OUTPUT_LEN, digest); 
+    if(header[0] != BULLET_PP_MAGIC || header[1] != RANGE_LEN || header[2] != AGG_NUM || header[3] != SEED.size() 
+       || memcmp(p + sizeof(header), SEED.data(), SEED.size()) != 0
+       || memcmp(p + file_len - HASH_OUTPUT_LEN, digest, HASH_OUTPUT_LEN) != 0) VALID = false; 
+
+    p += sizeof(header) + SEED.size(); 
+    vector<EC_POINT *> vec_A = {pp.g, pp.h, pp.u}; 
+    vec_A.insert(vec_A.end(), pp.vec_g.begin(), pp.vec_g.end()); 
+    vec_A.insert(vec_A.end(), pp.vec_h.begin(), pp.vec_h.end()); 
+    for(auto i = 0; i < vec_A.size() && VALID; i++)
+    {
+        if(EC_POINT_oct2point(group, vec_A[i], p, BULLET_PP_POINT_LEN, bn_ctx) != 1) VALID = false; 
+        p += BULLET_PP_POINT_LEN; 
+    }
+    munmap(base, file_len); 
 
-    // Eq (44) -- compute A = H^alpha g^aL h^aR (commitment to aL and aR)
-    BIGNUM *alpha = BN_new(); 
-    BN_random(alpha); 
+    // the digest only detects damage: check that the points are the ones Bullet_Setup derives from SEED
+    if(VALID && EC_POINT_cmp(group, pp.g, generator, bn_ctx) != 0) VALID = false; 
+    if(VALID)
+    {
+        EC_POINT *h = EC_POINT_new(group); 
+        Hash_ECP_to_ECP(pp.g, h); 
+        if(EC_POINT_cmp(group, pp.h, h, bn_ctx) != 0) VALID = false; 
+        EC_POINT_free(h); 
+    }
+    VALID = VALID && Hash_to_Curve_check(pp.u, SEED + ".u", 0, bn_ctx) 
+                  && Hash_to_Curve_vec_check(pp.vec_g, SEED + ".vec_g") 
+                  && Hash_to_Curve_vec_check(pp.vec_h, SEED + ".vec_h"); 
+    return VALID; 
+}
 
-    vec_A.emplace_back(pp.h); 
+/* load the pp from pp_file, or derive them from SEED and save them to pp_file if it does not hold them */
+void Bullet_Setup_Cached(Bullet_PP &pp, size_t &RANGE_LEN, size_t &AGG_NUM, string pp_file, 
+                         string SEED = BULLET_SEED)
+{
+    if(Bullet_PP_deserialize(pp, RANGE_LEN, AGG_NUM, pp_file, SEED) == true) return; 
+    Bullet_Setup(pp, RANGE_LEN, AGG_NUM, SEED); 
+    Bullet_PP_serialize(pp, pp_file); 
+}
+
+/*
+    precompute the fixed-base tables of g, h, u, vec_g, vec_h (see multiexp.hpp), used by Bullet_Prove for A, S, T1, T2, 
+    u^e and h'_i = h_i^{y^{-i+1}}, by Bullet_Commit and by the verifier: they take (3 + 2 Bullet_IP_len(n, m))*ceil(256/WINDOW_LEN)*64 bytes, e.g. 4.2 MB for 
+    n = 64, m = 64 and WINDOW_LEN = 32; a larger WINDOW_LEN (a multiple of 8) takes less memory and is slower 
+*/
+void Bullet_PP_precompute(Bullet_PP &pp, size_t WINDOW_LEN = 32, size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    vector<EC_POINT *> vec_A = {pp.g, pp.h, pp.u}; 
     vec_A.insert(vec_A.end(), pp.vec_g.begin(), pp.vec_g.end()); 
     vec_A.insert(vec_A.end(), pp.vec_h.begin(), pp.vec_h.end()); 
+    PointVec vec_P; 
+    PointVec_from_ECP(vec_P, vec_A, bn_ctx); 
+    PointVec_Table_build(pp.table, vec_P, WINDOW_LEN, THREAD_NUM); 
+}
+
+/* result = g^a h^b u^c (NULL for a zero exponent): on the fixed-base tables if pp has them, else with EC_POINTs_mul */
+void Bullet_PP_base_mul(const Bullet_PP &pp, EC_POINT *&result, BIGNUM *a, BIGNUM *b, BIGNUM *c, BN_CTX *ctx)
+{
+    BIGNUM *scalar[3] = {a, b, c}; 
+    EC_POINT *base[3] = {pp.g, pp.h, pp.u}; 
+    vector<BIGNUM *> vec_a; 
+    vector<EC_POINT *> vec_A; 
+    vector<PointVec_Slice> vec_slice; 
+    for (auto k = 0; k < 3; k++)
+    {
+        if (scalar[k] == NULL) continue; 
+        vec_a.emplace_back(scalar[k]); 
+        vec_A.emplace_back(base[k]); 
+        vec_slice.emplace_back(PointVec_Table_slice(pp.table, k, 1)); 
+    }
+    if (pp.table.WINDOW_LEN == 0) 
+    {
+        EC_POINTs_mul(group, result, NULL, vec_A.size(), (const EC_POINT**)vec_A.data(), (const BIGNUM**)vec_a.data(), ctx); 
+        return; 
+    }
+    vector<unsigned char> vec_scalar; 
+    MULTIEXP_scalar_bytes(vec_scalar, vec_a, ctx); 
+    PointVec_Table_multiexp(result, vec_slice, vec_scalar, pp.table.WINDOW_LEN, 1); 
+}
 
-    vec_a.emplace_back(alpha); 
-    vec_a.insert(vec_a.end(), vec_aL.begin(), vec_aL.end()); 
-    vec_a.insert(vec_a.end(), vec_aR.begin(), vec_aR.end()); 
+/* instance.C[j] = g^{r_j} h^{v_j}: the commitments to the witness */
+void Bullet_Commit(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witness)
+{
+    for (auto j = 0; j < pp.AGG_NUM; j++)
+    {
+        Bullet_PP_base_mul(pp, instance.C[j], witness.r[j], witness.v[j], NULL, bn_ctx); 
+    }
+}
 
-    ECP_vec_mul(proof.A, vec_A, vec_a); // Eq (44) 
+// statement C = g^r h^v and v \in [0, 2^n-1]
+/*
+    The prover streams over the l = nm coordinates: aL is read from the bits of v, the powers of y, y^{-1} and 2 
+    are generated per range of coordinates, and the coefficients of l(X), r(X) are recomputed where they are used, 
+    so the blinding vectors sL, sR are the only length-l vectors of the polynomials: they are overwritten by l(x) 
+    and r(x) and folded in place by the inner product rounds. Besides the affine copies of vec_g and vec_h, the 
+    prover keeps about 3l scalars: sL, sR and one buffer of nm+1 exponents for the multi-exponentiations. 
+    If nm is not a power of 2, l is nm rounded up to a power of 2 and the coordinates from nm on belong to dummy 
+    zero values with the public aL = 0, aR = -1, sL = sR = 0 and no z^{j+1} 2^k term: A and S only cover the nm 
+    coordinates (the verifier adds the -h_i of the padding itself), their part of t(X) is the constant 
+    (z - z^2) sum y^i in t0, and they only enter l(x) = -z and r(x) = y^i (z - 1) of the inner product argument. 
+*/
+void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witness, 
+                  string &transcript_str, Bullet_Proof &proof, 
+                  size_t THREAD_NUM = thread::hardware_concurrency())
+{ 
+    for (auto i = 0; i < instance.C.size(); i++){
+        transcript_str += ECP_ep2string(instance.C[i]); 
+    }
 
+    size_t NM = pp.RANGE_LEN * pp.AGG_NUM; // the coordinates of the values 
+    size_t l = pp.vec_g.size(); // l = nm padded to a power of 2 
+    if (THREAD_NUM == 0) THREAD_NUM = 1; 
 
-    // pick sL, sR from Z_p^n (choose blinding vectors sL, sR)
-    vector<BIGNUM *> vec_sL(l);
-    BN_vec_new(vec_sL); 
-    BN_vec_random(vec_sL); 
+    // Eq (41, 42) -- aL_i for i = (j-1)n + k is the k-th bit of v_j (0 on the padding), and aR = aL - 1^n 
+    auto aL_bit = [&](size_t i) { return i < NM && BN_is_bit_set(witness.v[i / pp.RANGE_LEN], i % pp.RANGE_LEN) == 1; }; 
 
-    vector<BIGNUM *> vec_sR(l);
-    BN_vec_new(vec_sR); 
-    BN_vec_random(vec_sR); 
-    
-    // Eq (47) compute S = H^alpha g^aL h^aR (commitment to sL and sR)
+    // Eq (44) -- compute A = H^alpha g^aL h^aR (commitment to aL and aR) over the nm coordinates 
+    // g^aL h^aR is the sum of g_i for aL_i = 1 and of h_i^{-1} for aL_i = 0: it needs no scalar multiplication 
+    BIGNUM *alpha = BN_new(); 
+    BN_random(alpha); 
+
+    PointVec vec_g, vec_h; 
+    PointVec_from_ECP(vec_g, pp.vec_g, bn_ctx); 
+    PointVec_from_ECP(vec_h, pp.vec_h, bn_ctx); 
+    vector<Jacobian_Point> vec_A_partial(THREAD_NUM); 
+    for (auto t = 0; t < THREAD_NUM; t++) Jacobian_set_infinity(vec_A_partial[t]); 
+    Parallel_For(NM, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+    {
+        Affine_Point h_inverse; 
+        for (auto i = start; i < end; i++)
+        {
+            if (aL_bit(i)) Jacobian_add_affine(vec_A_partial[t], vec_A_partial[t], vec_g[i]); 
+            else
+            {
+                Affine_negate(h_inverse, vec_h[i]); 
+                Jacobian_add_affine(vec_A_partial[t], vec_A_partial[t], h_inverse); 
+            }
+        }
+    }, THREAD_NUM); 
+    for (auto t = 1; t < THREAD_NUM; t++) Jacobian_add(vec_A_partial[0], vec_A_partial[0], vec_A_partial[t]); 
+    Jacobian_to_ECP(proof.A, vec_A_partial[0], bn_ctx); 
+    EC_POINT *h_alpha = EC_POINT_new(group); 
+    Bullet_PP_base_mul(pp, h_alpha, NULL, alpha, NULL, bn_ctx); 
+    EC_POINT_add(group, proof.A, proof.A, h_alpha, bn_ctx); // Eq (44) 
+
+    // pick sL, sR from Z_p^n (choose blinding vectors sL, sR), 0 on the padding 
+    Scalar S_zero; 
+    Scalar_zero(S_zero); 
+    ScalarVec vec_sL(l, S_zero), vec_sR(l, S_zero); 
+    Parallel_For(NM, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+    {
+        for (auto i = start; i < end; i++) Scalar_random(vec_sL[i]), Scalar_random(vec_sR[i]); 
+    }, THREAD_NUM); 
+
+    // Eq (47) compute S = H^rho g^sL h^sR (commitment to sL and sR) as (g^sL H^rho) h^sR over the nm coordinates, 
+    // so that the two multi-exponentiations share one buffer of nm+1 exponents 
     BIGNUM *rho = BN_new(); 
     BN_random(rho); 
 
-    vec_a.clear(); 
-    vec_a.emplace_back(rho); 
-    vec_a.insert(vec_a.end(), vec_sL.begin(), vec_sL.end()); 
-    vec_a.insert(vec_a.end(), vec_sR.begin(), vec_sR.end()); 
+    vector<unsigned char> vec_scalar((NM+1)*BN_LEN); 
+    Parallel_For(NM, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+    {
+        for (auto i = start; i < end; i++) Scalar_to_bytes(&vec_scalar[i*BN_LEN], vec_sL[i]); 
+    }, THREAD_NUM); 
+    BN_bn2binpad(rho, &vec_scalar[NM*BN_LEN], BN_LEN); 
+    PointVec vec_H(1); 
+    BIGNUM *bn_temp1 = BN_new(); 
+    BIGNUM *bn_temp2 = BN_new(); 
+    Affine_from_ECP(vec_H[0], pp.h, bn_temp1, bn_temp2, bn_ctx); 
+    vector<PointVec_Slice> vec_slice; 
+    if (pp.table.WINDOW_LEN != 0) 
+    {
+        vec_slice = {PointVec_Table_slice(pp.table, 3, NM), PointVec_Table_slice(pp.table, 1, 1)}; 
+        PointVec_Table_multiexp(proof.S, vec_slice, vec_scalar, pp.table.WINDOW_LEN, THREAD_NUM); 
+    }
+    else 
+    {
+        vec_slice = {PointVec_slice(vec_g, 0, NM), PointVec_slice(vec_H, 0, 1)}; 
+        PointVec_multiexp(proof.S, vec_slice, vec_scalar, 8*BN_LEN, THREAD_NUM); 
+    }
 
-    ECP_vec_mul(proof.S, vec_A, vec_a); // Eq (47) 
+    vec_scalar.resize(NM*BN_LEN); 
+    Parallel_For(NM, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+    {
+        for (auto i = start; i < end; i++) Scalar_to_bytes(&vec_scalar[i*BN_LEN], vec_sR[i]); 
+    }, THREAD_NUM); 
+    EC_POINT *h_sR = EC_POINT_new(group); 
+    if (pp.table.WINDOW_LEN != 0) 
+    {
+        vec_slice = {PointVec_Table_slice(pp.table, 3 + l, NM)}; 
+        PointVec_Table_multiexp(h_sR, vec_slice, vec_scalar, pp.table.WINDOW_LEN, THREAD_NUM); 
+    }
+    else 
+    {
+        vec_slice = {PointVec_slice(vec_h, 0, NM)}; 
+        PointVec_multiexp(h_sR, vec_slice, vec_scalar, 8*BN_LEN, THREAD_NUM); 
+    }
+    EC_POINT_add(group, proof.S, proof.S, h_sR, bn_ctx); // Eq (47) 
+    vector<unsigned char>().swap(vec_scalar); 
 
     // Eq (49, 50) compute y and z
     transcript_str += ECP_ep2string(proof.A); 
@@ -245,18 +481,9 @@ void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witn
     BIGNUM* y_inverse = BN_new();
     BN_mod_inverse(y_inverse, y, order, bn_ctx); 
 
-    vector<BIGNUM *> vec_y_inverse_power(l); 
-    BN_vec_new(vec_y_inverse_power); 
-    BN_vec_gen_power(vec_y_inverse_power, y_inverse); // y^{-i+1}
-
     transcript_str += ECP_ep2string(proof.S); 
     BIGNUM *z = BN_new(); 
     Hash_String_to_BN(transcript_str, z);
-
-    BIGNUM *z_square = BN_new(); 
-    BN_mod_sqr(z_square, z, order, bn_ctx);
-    BIGNUM *z_cubic = BN_new(); 
-    BN_mod_mul(z_cubic, z, z_square, order, bn_ctx);
     
     vector<BIGNUM *> vec_adjust_z_power(pp.AGG_NUM+1); // generate z^{j+1} j \in [n]
     BN_vec_new(vec_adjust_z_power); 
@@ -267,69 +494,87 @@ void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witn
         //vec_adjust_z_power[j] = pow(z, j+1, q); description below Eq (71)
     }  
 
-    // prepare the vector polynomials
-    
-    // compute l(X) Eq (70)
-    vector<BIGNUM *> vec_z_unary(l); 
-    BN_vec_new(vec_z_unary); 
-    BN_vec_scalar(vec_z_unary, vec_1_power, z); // z \cdot 1^nm
-
-    vector<BIGNUM *> poly_ll0(l);
-    BN_vec_new(poly_ll0); 
-    vector<BIGNUM *> poly_ll1(l);
-    BN_vec_new(poly_ll1); 
-    BN_vec_sub(poly_ll0, vec_aL, vec_z_unary);  
-    BN_vec_copy(poly_ll1, vec_sL); 
-
-    // compute r(X)     
-    vector<BIGNUM *> poly_rr0(l); 
-    BN_vec_new(poly_rr0); 
-
-    vector<BIGNUM *> vec_y_power(l); 
-    BN_vec_new(vec_y_power); 
-    BN_vec_gen_power(vec_y_power, y); // y^nm
-
-    vector<BIGNUM *> vec_zz_temp(l); 
-    BN_vec_new(vec_zz_temp); 
-    BN_vec_add(vec_zz_temp, vec_z_unary, vec_aR); // vec_t = aR + z1^nm
-    BN_vec_product(poly_rr0, vec_y_power, vec_zz_temp); // y^nm(aR + z1^nm)
-    
-    vector<BIGNUM *> vec_short_2_power(pp.RANGE_LEN); 
-    BN_vec_new(vec_short_2_power); 
-    BN_vec_gen_power(vec_short_2_power, BN_2); // 2^n
-
-    for (auto j = 1; j <= pp.AGG_NUM; j++)
+    // the vector polynomials l(X) = ll0 + ll1 X and r(X) = rr0 + rr1 X, Eq (70, 71), with ll1 = sL, rr1 = y^nm o sR 
+    // the scalar work runs on Montgomery scalars, BIGNUMs only enter and leave at the edges 
+    Scalar S_one, S_two, S_y, S_y_inverse, S_z; 
+    Scalar_one(S_one); 
+    Scalar_add(S_two, S_one, S_one); 
+    Scalar_from_BN(S_y, y, bn_ctx); 
+    Scalar_from_BN(S_y_inverse, y_inverse, bn_ctx); 
+    Scalar_from_BN(S_z, z, bn_ctx); 
+    ScalarVec vec_adjust_z_scalar; 
+    ScalarVec_from_BN(vec_adjust_z_scalar, vec_adjust_z_power, bn_ctx); 
+
+    // ll0_i = aL_i - z and rr0_i = y^i (aR_i + z) + z^{j+1} 2^k for i = (j-1)n + k < nm, with y_power = y^i, two_power = 2^k 
+    auto poly_coefficient = [&](size_t i, const Scalar &y_power, const Scalar &two_power, Scalar &ll0, Scalar &rr0)
+    {
+        const Scalar &aL = aL_bit(i) ? S_one : S_zero; 
+        Scalar temp; 
+        Scalar_sub(ll0, aL, S_z); 
+        Scalar_sub(rr0, aL, S_one); 
+        Scalar_add(rr0, rr0, S_z); 
+        Scalar_mul(rr0, rr0, y_power); 
+        if (i >= NM) return; 
+        Scalar_mul(temp, vec_adjust_z_scalar[i / pp.RANGE_LEN + 1], two_power); 
+        Scalar_add(rr0, rr0, temp); 
+    }; 
+
+    // compute t(X) = t0 + t1 X + t2 X^2 from per-thread partial inner products over the nm coordinates 
+    ScalarVec vec_t_partial(3*THREAD_NUM, S_zero); 
+    Parallel_For(NM, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
     {
-        for (auto i = 0; i < (j-1)*pp.RANGE_LEN; i++) 
-            BN_zero(vec_zz_temp[i]); 
-        for (auto i = 0; i < pp.RANGE_LEN; i++) 
-            BN_copy(vec_zz_temp[(j-1)*pp.RANGE_LEN+i], vec_short_2_power[i]); 
-        for (auto i = 0; i < (pp.AGG_NUM-j)*pp.RANGE_LEN; i++) 
-            BN_zero(vec_zz_temp[j*pp.RANGE_LEN+i]);
+        Scalar y_power, two_power, ll0, rr0, rr1, temp; 
+        Scalar_pow(y_power, S_y, start); 
+        Scalar_pow(two_power, S_two, start % pp.RANGE_LEN); 
+        for (auto i = start; i < end; i++)
+        {
+            if (i % pp.RANGE_LEN == 0) two_power = S_one; 
+            poly_coefficient(i, y_power, two_power, ll0, rr0); 
+            Scalar_mul(rr1, y_power, vec_sR[i]); 
+
+            Scalar_mul(temp, ll0, rr0);                 // t0 = <ll0, rr0>
+            Scalar_add(vec_t_partial[3*t], vec_t_partial[3*t], temp); 
+            Scalar_mul(temp, vec_sL[i], rr0);           // t1 = <ll1, rr0> + <ll0, rr1>
+            Scalar_add(vec_t_partial[3*t+1], vec_t_partial[3*t+1], temp); 
+            Scalar_mul(temp, ll0, rr1); 
+            Scalar_add(vec_t_partial[3*t+1], vec_t_partial[3*t+1], temp); 
+            Scalar_mul(temp, vec_sL[i], rr1);           // t2 = <ll1, rr1>
+            Scalar_add(vec_t_partial[3*t+2], vec_t_partial[3*t+2], temp); 
+
+            Scalar_mul(y_power, y_power, S_y); 
+            Scalar_add(two_power, two_power, two_power); 
+        }
+    }, THREAD_NUM); 
 
-        BN_vec_scalar(vec_zz_temp, vec_zz_temp, vec_adjust_z_power[j]); 
-        //BN_print(vec_adjust_z_power[j], "adjust_vec_z"); 
-        BN_vec_add(poly_rr0, poly_rr0, vec_zz_temp);  
+    Scalar S_t0 = S_zero, S_t1 = S_zero, S_t2 = S_zero; 
+    for (auto t = 0; t < THREAD_NUM; t++)
+    {
+        Scalar_add(S_t0, S_t0, vec_t_partial[3*t]); 
+        Scalar_add(S_t1, S_t1, vec_t_partial[3*t+1]); 
+        Scalar_add(S_t2, S_t2, vec_t_partial[3*t+2]); 
+    }
+    // the padding adds <-z 1, y^i (z - 1)> = (z - z^2) (y^l - y^nm)/(y - 1) to t0 
+    if (NM < l)
+    {
+        Scalar y_power_l, y_power_nm, temp; 
+        Scalar_pow(y_power_l, S_y, l); 
+        Scalar_pow(y_power_nm, S_y, NM); 
+        Scalar_sub(y_power_l, y_power_l, y_power_nm); 
+        Scalar_sub(temp, S_y, S_one); 
+        Scalar_inverse_mod(temp, temp, Scalar_field()); 
+        Scalar_mul(y_power_l, y_power_l, temp); 
+        Scalar_mul(temp, S_z, S_z); 
+        Scalar_sub(temp, S_z, temp); 
+        Scalar_mul(temp, temp, y_power_l); 
+        Scalar_add(S_t0, S_t0, temp); 
     }
-    vector<BIGNUM *> poly_rr1(l); 
-    BN_vec_new(poly_rr1); 
-    BN_vec_product(poly_rr1, vec_y_power, vec_sR); //y^nsR X
 
-    // compute t(X) 
     BIGNUM* bn_temp  = BN_new(); 
-    BIGNUM* bn_temp1 = BN_new(); 
-    BIGNUM* bn_temp2 = BN_new(); 
     
-    BIGNUM* t0 = BN_new(); 
     BIGNUM* t1 = BN_new(); 
     BIGNUM* t2 = BN_new(); 
-    
-    BN_vec_inner_product(t0, poly_ll0, poly_rr0); 
-    BN_vec_inner_product(bn_temp1, poly_ll1, poly_rr0); 
-    BN_vec_inner_product(bn_temp2, poly_ll0, poly_rr1);
-    BN_mod_add(t1, bn_temp1, bn_temp2, order, bn_ctx);  
-  
-    BN_vec_inner_product(t2, poly_ll1, poly_rr1); 
+    Scalar_to_BN(t1, S_t1); 
+    Scalar_to_BN(t2, S_t2); 
 
     // Eq (53) -- commit to t1, t2
     // P picks tau1 and tau2
@@ -338,8 +583,8 @@ void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witn
     BIGNUM* tau2 = BN_new(); 
     BN_random(tau2);
 
-    EC_POINT_mul(group, proof.T1, tau1, pp.h, t1, bn_ctx); // mul(tau1, pp.g, t1, pp.h);
-    EC_POINT_mul(group, proof.T2, tau2, pp.h, t2, bn_ctx); // mul(tau2, pp.g, t2, pp.h);    
+    Bullet_PP_base_mul(pp, proof.T1, tau1, t1, NULL, bn_ctx); // mul(tau1, pp.g, t1, pp.h);
+    Bullet_PP_base_mul(pp, proof.T2, tau2, t2, NULL, bn_ctx); // mul(tau2, pp.g, t2, pp.h);    
 
     // Eq (56) -- compute the challenge x
     transcript_str += ECP_ep2string(proof.T1) + ECP_ep2string(proof.T2); 
@@ -349,18 +594,37 @@ void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witn
     BIGNUM* x_square = BN_new(); 
     BN_mod_sqr(x_square, x, order, bn_ctx);  
 
-    // compute the value of l(x) and r(x) at point x
-    vector<BIGNUM *> llx(l); 
-    BN_vec_new(llx);
-    BN_vec_scalar(vec_zz_temp, poly_ll1, x);
-    BN_vec_add(llx, poly_ll0, vec_zz_temp);
-
-    vector<BIGNUM *> rrx(l); 
-    BN_vec_new(rrx);
-    BN_vec_scalar(vec_zz_temp, poly_rr1, x); 
-    BN_vec_add(rrx, poly_rr0, vec_zz_temp); 
-
-    BN_vec_inner_product(proof.tx, llx, rrx);  // Eq (60)  
+    // compute the value of l(x) and r(x) at point x in place of sL and sR 
+    Scalar S_x; 
+    Scalar_from_BN(S_x, x, bn_ctx); 
+    Parallel_For(l, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+    {
+        Scalar y_power, two_power, ll0, rr0; 
+        Scalar_pow(y_power, S_y, start); 
+        Scalar_pow(two_power, S_two, start % pp.RANGE_LEN); 
+        for (auto i = start; i < end; i++)
+        {
+            if (i % pp.RANGE_LEN == 0) two_power = S_one; 
+            poly_coefficient(i, y_power, two_power, ll0, rr0); 
+            Scalar_mul(vec_sL[i], vec_sL[i], S_x);      // llx = ll0 + sL x 
+            Scalar_add(vec_sL[i], vec_sL[i], ll0); 
+            Scalar_mul(vec_sR[i], vec_sR[i], S_x);      // rrx = rr0 + y^i sR x 
+            Scalar_mul(vec_sR[i], vec_sR[i], y_power); 
+            Scalar_add(vec_sR[i], vec_sR[i], rr0); 
+
+            Scalar_mul(y_power, y_power, S_y); 
+            Scalar_add(two_power, two_power, two_power); 
+        }
+    }, THREAD_NUM); 
+    ScalarVec &llx = vec_sL, &rrx = vec_sR; 
+
+    // Eq (60) tx = <llx, rrx> = t0 + t1 x + t2 x^2 
+    Scalar S_tx; 
+    Scalar_mul(S_tx, S_t2, S_x); 
+    Scalar_add(S_tx, S_tx, S_t1); 
+    Scalar_mul(S_tx, S_tx, S_x); 
+    Scalar_add(S_tx, S_tx, S_t0); 
+    Scalar_to_BN(proof.tx, S_tx); 
  
     // compute taux
     BN_mul(bn_temp1, tau1, x, bn_ctx);
@@ -376,259 +640,364 @@ void Bullet_Prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witn
     BN_mul(proof.mu, rho, x, bn_ctx); 
     BN_mod_add(proof.mu, proof.mu, alpha, order, bn_ctx); 
     
-    // transmit llx and rrx via inner product proof
-    vector<EC_POINT *> vec_h_new(l); 
-    ECP_vec_new(vec_h_new); 
-    ECP_vec_product(vec_h_new, pp.vec_h, vec_y_inverse_power); 
-
-    InnerProduct_PP ip_pp; 
-    InnerProduct_PP_new(ip_pp, pp.RANGE_LEN*pp.AGG_NUM); 
-    InnerProduct_Setup(ip_pp, pp.RANGE_LEN*pp.AGG_NUM, false); 
-    ECP_vec_copy(ip_pp.vec_g, pp.vec_g); // ip_pp.vec_g = pp.vec_g
-    ECP_vec_copy(ip_pp.vec_h, vec_h_new);  // ip_pp.vec_h = vec_h_new  
+    // transmit llx and rrx via inner product proof on the generators vec_g and h'_i = h_i^{y^{-i+1}}, 
+    // computed in place of vec_h 
+    Parallel_For(l, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+    {
+        vector<Jacobian_Point> vec_J(min(end - start, INNERPRODUCT_FOLD_BLOCK)); 
+        Scalar y_inverse_power; 
+        Scalar_pow(y_inverse_power, S_y_inverse, start); 
+        unsigned char y_inverse_power_bytes[BN_LEN]; 
+        for (auto block = start; block < end; block += INNERPRODUCT_FOLD_BLOCK)
+        {
+            size_t block_len = min(end - block, INNERPRODUCT_FOLD_BLOCK); 
+            for (auto i = block; i < block + block_len; i++)
+            {
+                Scalar_to_bytes(y_inverse_power_bytes, y_inverse_power); 
+                if (pp.table.WINDOW_LEN != 0) Jacobian_mul_table(vec_J[i-block], pp.table, 3 + l + i, y_inverse_power_bytes); 
+                else Jacobian_mul(vec_J[i-block], vec_h[i], y_inverse_power_bytes); 
+                Scalar_mul(y_inverse_power, y_inverse_power, S_y_inverse); 
+            }
+            Jacobian_vec_normalize(&vec_h[block], vec_J.data(), block_len); 
+        }
+    }, THREAD_NUM); 
 
     transcript_str += BN_bn2string(x); 
     BIGNUM* e = BN_new(); 
     Hash_String_to_BN(transcript_str, e);   
 
-    InnerProduct_Witness ip_witness;
-    InnerProduct_Witness_new(ip_witness, l); 
-    BN_vec_copy(ip_witness.vec_a, llx); // ip_witness.vec_a = llx
-    BN_vec_copy(ip_witness.vec_b, rrx); // ip_witness.vec_b = rrx
+    EC_POINT *ip_u = EC_POINT_new(group); 
+    Bullet_PP_base_mul(pp, ip_u, NULL, NULL, e, bn_ctx); // the inner product argument uses u^e 
+    Affine_Point u; 
+    Affine_from_ECP(u, ip_u, bn_temp1, bn_temp2, bn_ctx); 
 
-    InnerProduct_Instance ip_instance;
-    InnerProduct_Instance_new(ip_instance);
-    EC_POINT_copy(ip_instance.u, pp.u); // ip_instance.u = pp.u
-    EC_POINT_mul(group, ip_instance.u, NULL, ip_instance.u, e, bn_ctx); //ip_instance.u = u^e 
-
-    vec_A.clear(); vec_a.clear();
-
-    vec_A.emplace_back(ip_instance.u); 
-    vec_A.insert(vec_A.end(), ip_pp.vec_g.begin(), ip_pp.vec_g.end()); 
-    vec_A.insert(vec_A.end(), ip_pp.vec_h.begin(), ip_pp.vec_h.end()); 
-
-    vec_a.emplace_back(proof.tx); 
-    vec_a.insert(vec_a.end(), ip_witness.vec_a.begin(), ip_witness.vec_a.end()); 
-    vec_a.insert(vec_a.end(), ip_witness.vec_b.begin(), ip_witness.vec_b.end()); 
-
-    ECP_vec_mul(ip_instance.P, vec_A, vec_a);  
-
-    transcript_str += ECP_ep2string(ip_instance.P) + ECP_ep2string(ip_instance.u);  
+    // the instance P of the inner product argument is not computed: the prover does not need it, and it is 
+    // determined by A, S, the challenges, tx and mu, so the verifier recomputes it inside its one equation 
+    transcript_str += BN_bn2string(proof.tx) + BN_bn2string(proof.taux) + BN_bn2string(proof.mu); 
  
-    InnerProduct_Prove(ip_pp, ip_instance, ip_witness, transcript_str, proof.ip_proof); 
+    InnerProduct_Prove_Rounds(vec_g, vec_h, u, llx, rrx, transcript_str, proof.ip_proof, THREAD_NUM); 
 
     #ifdef DEBUG
         cout << "Bullet Proof Generation Succeeds >>>" << endl; 
     #endif
 
-    BN_vec_free(vec_aL), BN_vec_free(vec_aR); 
-    BN_vec_free(vec_1_power);
     BN_free(alpha), BN_free(rho);
-    BN_vec_free(vec_sL), BN_vec_free(vec_sR);
-    BN_free(x); 
+    EC_POINT_free(h_alpha), EC_POINT_free(h_sR); 
+    BN_free(x), BN_free(x_square); 
     BN_free(y), BN_free(y_inverse);  
-    BN_vec_free(vec_y_power), BN_vec_free(vec_y_inverse_power); 
-    BN_free(z), BN_free(z_square), BN_free(z_cubic); 
+    BN_free(z); 
     BN_vec_free(vec_adjust_z_power); 
-    BN_vec_free(vec_z_unary); 
     BN_free(e); 
-
-    BN_vec_free(poly_ll0), BN_vec_free(poly_ll1);  
-    BN_vec_free(poly_rr0), BN_vec_free(poly_rr1);  
+    EC_POINT_free(ip_u); 
 
     BN_free(tau1), BN_free(tau2); 
-    BN_vec_free(llx), BN_vec_free(rrx);  
-
-    ECP_vec_free(vec_h_new); 
 
     BN_free(bn_temp), BN_free(bn_temp1), BN_free(bn_temp2); 
-    BN_free(t0), BN_free(t1), BN_free(t2);  
+    BN_free(t1), BN_free(t2);  
+}
 
-    InnerProduct_PP_free(ip_pp); 
-    InnerProduct_Witness_free(ip_witness); 
-    InnerProduct_Instance_free(ip_instance); 
+/*
+    The verifier checks Eq (72) and the inner product argument with one multi-exponentiation (Section 6.2): 
+    the inner product check g^{a*s} h'^{b*s^{-1}} u'^{ab} = P prod_k L_k^{x_k^2} R_k^{x_k^{-2}} is expanded with 
+    P = A S^x g^{-z} h'^{z y^nm + z^{j+1} 2^n} h^{-mu} u'^{tx} and h'_i = h_i^{y^{-i}}, 
+    Eq (72) is added with a random weight c, and the sum of all terms must be the point at infinity. 
+    If nm is not a power of 2, the padded coordinates are those of dummy zero values with the public aL = 0, 
+    aR = -1, sL = sR = 0 and no z^{j+1} 2^k term: A and S do not cover them, so P gets their h_i^{-1} from the 
+    verifier, which folds it with -z into the scalar of h_i, and they are in delta_yz like the others. Whatever a 
+    prover puts on the padded generators in A or S is then constrained like the bits of the values. 
+    No intermediate point is computed, so the inner product transcript binds tx, taux and mu instead of P. 
+    A batch of proofs is checked the same way: the equation of each proof is scaled by a random weight and 
+    the scalars of the shared generators vec_g, vec_h, u, h, g are summed, so they appear in the sum only once. 
+*/
+
+/* the scalars of the shared generators in the combined equation: vec_g, vec_h, then u, h, g */
+struct Bullet_Verify_Terms
+{
+    vector<BIGNUM *> vec_g_scalar; 
+    vector<BIGNUM *> vec_h_scalar; 
+    vector<BIGNUM *> vec_base_scalar; 
+    vector<EC_POINT *> vec_A;   // the points of the proofs
+    vector<BIGNUM *> vec_a;     // their scalars (owned)
+}; 
+
+void Bullet_Verify_Terms_new(const Bullet_PP &pp, Bullet_Verify_Terms &terms)
+{
+    size_t l = pp.vec_g.size(); 
+    terms.vec_g_scalar.resize(l); BN_vec_new(terms.vec_g_scalar); 
+    terms.vec_h_scalar.resize(l); BN_vec_new(terms.vec_h_scalar); 
+    terms.vec_base_scalar.resize(3); BN_vec_new(terms.vec_base_scalar); 
+    for (auto i = 0; i < l; i++) BN_zero(terms.vec_g_scalar[i]), BN_zero(terms.vec_h_scalar[i]); 
+    for (auto i = 0; i < 3; i++) BN_zero(terms.vec_base_scalar[i]); 
 }
 
-bool Bullet_Verify(Bullet_PP &pp, Bullet_Instance &instance, string &transcript_str, Bullet_Proof &proof)
+void Bullet_Verify_Terms_free(Bullet_Verify_Terms &terms)
 {
-    #ifdef DEBUG
-        cout << "begin to check the proof" << endl; 
-    #endif
+    BN_vec_free(terms.vec_g_scalar); 
+    BN_vec_free(terms.vec_h_scalar); 
+    BN_vec_free(terms.vec_base_scalar); 
+    BN_vec_free(terms.vec_a); 
+}
+
+/* append a point of a proof with scalar -weight*a to the terms */
+inline void Bullet_Verify_Terms_sub(Bullet_Verify_Terms &terms, EC_POINT *A, const BIGNUM *weight, const BIGNUM *a, 
+                                    BN_CTX *ctx)
+{
+    BIGNUM *scalar = BN_new(); 
+    BN_mod_mul(scalar, weight, a, order, ctx); 
+    BN_mod_sub(scalar, BN_0, scalar, order, ctx); 
+    terms.vec_A.emplace_back(A); 
+    terms.vec_a.emplace_back(scalar); 
+}
+
+/* 
+    add weight times the verification equation of (instance, proof) to terms: 
+    return false if the proof is malformed (it is then not added)
+    the transcript is extended on a local copy, and pp, instance and proof are only read 
+*/
+bool Bullet_Verify_add(const Bullet_PP &pp, const Bullet_Instance &instance, string transcript_str, 
+                       const Bullet_Proof &proof, const BIGNUM *weight, Bullet_Verify_Terms &terms, BN_CTX *ctx)
+{
+    size_t l = pp.RANGE_LEN * pp.AGG_NUM; 
+    size_t IP_LEN = pp.vec_g.size(); 
+    size_t LOG_LEN = log2(IP_LEN); 
+    if(instance.C.size() != pp.AGG_NUM || proof.ip_proof.vec_L.size() != LOG_LEN 
+       || proof.ip_proof.vec_R.size() != LOG_LEN) return false; 
 
     for (auto i = 0; i < instance.C.size(); i++){
-        transcript_str += ECP_ep2string(instance.C[i]); 
+        transcript_str += ECP_ep2string(instance.C[i], ctx); 
     }
 
-    bool V1, V2, Validity; // variables for checking results
-
-    transcript_str += ECP_ep2string(proof.A); 
+    transcript_str += ECP_ep2string(proof.A, ctx); 
     BIGNUM* y = BN_new(); 
-    Hash_String_to_BN(transcript_str, y);   
+    Hash_String_to_BN(transcript_str, y, ctx);   
     BIGNUM* y_inverse = BN_new(); 
-    BN_mod_inverse(y_inverse, y, order, bn_ctx); //recover the challenge y
+    BN_mod_inverse(y_inverse, y, order, ctx); //recover the challenge y
     
-    transcript_str += ECP_ep2string(proof.S); 
+    transcript_str += ECP_ep2string(proof.S, ctx); 
     BIGNUM* z = BN_new(); 
-    BIGNUM* z_minus = BN_new(); 
     BIGNUM* z_square = BN_new(); 
-    BIGNUM* z_cubic = BN_new(); 
-
-    Hash_String_to_BN(transcript_str, z); 
-    BN_mod_sub(z_minus, BN_0, z, order, bn_ctx); 
-    BN_mod_sqr(z_square, z, order, bn_ctx); // (z*z)%q; 
-    BN_mod_mul(z_cubic, z, z_square, order, bn_ctx); //recover the challenge z from PI
+    Hash_String_to_BN(transcript_str, z, ctx); 
+    BN_mod_sqr(z_square, z, order, ctx); //recover the challenge z from PI
 
-    transcript_str += ECP_ep2string(proof.T1) + ECP_ep2string(proof.T2); 
+    transcript_str += ECP_ep2string(proof.T1, ctx) + ECP_ep2string(proof.T2, ctx); 
     BIGNUM *x = BN_new(); 
-    Hash_String_to_BN(transcript_str, x); 
+    Hash_String_to_BN(transcript_str, x, ctx); 
     BIGNUM *x_square = BN_new(); 
-    BN_mod_sqr(x_square, x, order, bn_ctx); // (x*x)%q;  //recover the challenge x from PI
+    BN_mod_sqr(x_square, x, order, ctx); //recover the challenge x from PI
 
     transcript_str += BN_bn2string(x); 
     BIGNUM *e = BN_new(); 
-    Hash_String_to_BN(transcript_str, e);  
-
-    size_t l = pp.RANGE_LEN * pp.AGG_NUM; 
-
-    vector<BIGNUM *> vec_1_power(l); // vec_unary = 1^nm
-    BN_vec_new(vec_1_power); 
-    BN_vec_one(vec_1_power); 
-    
-    vector<BIGNUM *> vec_short_1_power(pp.RANGE_LEN);
-    BN_vec_new(vec_short_1_power); 
-    BN_vec_gen_power(vec_short_1_power, BN_1); 
-
-    vector<BIGNUM *> vec_2_power(l); 
-    BN_vec_new(vec_2_power); 
-    BN_vec_gen_power(vec_2_power, BN_2);
+    Hash_String_to_BN(transcript_str, e, ctx);  
+
+    // recover the challenges of the inner product argument
+    transcript_str += BN_bn2string(proof.tx) + BN_bn2string(proof.taux) + BN_bn2string(proof.mu); 
+    vector<BIGNUM *> vec_x(LOG_LEN), vec_x_inverse(LOG_LEN); 
+    BN_vec_new(vec_x); 
+    BN_vec_new(vec_x_inverse); 
+    for (auto k = 0; k < LOG_LEN; k++)
+    {  
+        transcript_str += ECP_ep2string(proof.ip_proof.vec_L[k], ctx) + ECP_ep2string(proof.ip_proof.vec_R[k], ctx); 
+        Hash_String_to_BN(transcript_str, vec_x[k], ctx); 
+    }
+    BN_vec_batch_inverse(vec_x_inverse, vec_x, ctx); 
 
+    vector<BIGNUM *> vec_y_power(IP_LEN); 
+    BN_vec_new(vec_y_power); 
+    BN_vec_gen_power(vec_y_power, y, ctx); 
+    vector<BIGNUM *> vec_y_inverse_power(IP_LEN); 
+    BN_vec_new(vec_y_inverse_power); 
+    BN_vec_gen_power(vec_y_inverse_power, y_inverse, ctx); 
     vector<BIGNUM *> vec_short_2_power(pp.RANGE_LEN);
     BN_vec_new(vec_short_2_power); 
-    BN_vec_gen_power(vec_short_2_power, BN_2);  
+    BN_vec_gen_power(vec_short_2_power, BN_2, ctx);  
 
-    vector<BIGNUM *> vec_y_power(l); 
-    BN_vec_new(vec_y_power); 
-    BN_vec_gen_power(vec_y_power, y); 
-
-    vector<BIGNUM *> vec_adjust_z_power(pp.AGG_NUM+1); // generate z^{j+2} j \in [n]
+    vector<BIGNUM *> vec_adjust_z_power(pp.AGG_NUM+1); // z^{j+1} for j \in [m]
     BN_vec_new(vec_adjust_z_power); 
     BN_copy(vec_adjust_z_power[0], z); 
     for (auto j = 1; j <= pp.AGG_NUM; j++)
     {
-        BN_mod_mul(vec_adjust_z_power[j], z, vec_adjust_z_power[j-1], order, bn_ctx); 
+        BN_mod_mul(vec_adjust_z_power[j], z, vec_adjust_z_power[j-1], order, ctx); 
     }  
 
-    // compute sum_{j=1^m} z^{j+2}
-    BIGNUM* sum_z = BN_new(); 
-    BN_zero(sum_z); 
-    for (auto j = 1; j <= pp.AGG_NUM; j++)
+    // compute delta_yz = (z - z^2) <1^l, y^l> - sum_{j=1^m} z^{j+2} <1^n, 2^n> (pp. 21), l = nm padded to a power of 2
+    BIGNUM *delta_yz = BN_new(); 
+    BIGNUM *bn_temp1 = BN_new(); 
+    BIGNUM *bn_temp2 = BN_new(); 
+    BN_zero(bn_temp1); 
+    for (auto i = 0; i < IP_LEN; i++) BN_mod_add(bn_temp1, bn_temp1, vec_y_power[i], order, ctx); 
+    BN_mod_sub(bn_temp2, z, z_square, order, ctx); 
+    BN_mod_mul(delta_yz, bn_temp1, bn_temp2, order, ctx); 
+    BN_zero(bn_temp1); 
+    for (auto j = 1; j <= pp.AGG_NUM; j++) BN_mod_add(bn_temp1, bn_temp1, vec_adjust_z_power[j], order, ctx); 
+    BN_mod_mul(bn_temp1, bn_temp1, z, order, ctx); 
+    BN_lshift(bn_temp2, BN_1, pp.RANGE_LEN); 
+    BN_sub_word(bn_temp2, 1);                                     // <1^n, 2^n> = 2^n - 1 
+    BN_mod_mul(bn_temp1, bn_temp1, bn_temp2, order, ctx); 
+    BN_mod_sub(delta_yz, delta_yz, bn_temp1, order, ctx);  //Eq (39)
+
+    // the s vector (page 15): s_i = prod_k x_k^{+-1}, and s_{IP_LEN-1-i} = s_i^{-1}
+    vector<BIGNUM *> vec_s(IP_LEN); 
+    BN_vec_new(vec_s); 
+    compute_vec_ss(vec_s, vec_x, vec_x_inverse, ctx); 
+
+    BIGNUM *c = BN_new();  // the weight of Eq (72): a random c times the weight of the proof
+    BN_random(c); 
+    BN_mod_mul(c, c, weight, order, ctx); 
+    BIGNUM *bn_temp = BN_new(); 
+
+    // g_i: weight (a*s_i + z) 
+    for (auto i = 0; i < IP_LEN; i++)
     {
-        BN_add(sum_z, sum_z, vec_adjust_z_power[j]); 
+        BN_mod_mul(bn_temp, proof.ip_proof.a, vec_s[i], order, ctx); 
+        BN_mod_add(bn_temp, bn_temp, z, order, ctx); 
+        BN_mod_mul(bn_temp, bn_temp, weight, order, ctx); 
+        BN_mod_add(terms.vec_g_scalar[i], terms.vec_g_scalar[i], bn_temp, order, ctx); 
     }
-    BN_mul(sum_z, sum_z, z, bn_ctx); 
-    BN_mod(sum_z, sum_z, order, bn_ctx); 
-
-    // compute delta_yz (pp. 21)
-    BIGNUM* delta_yz = BN_new(); 
-
-    BIGNUM* bn_temp0 = BN_new(); 
-    BIGNUM* bn_temp1 = BN_new(); 
-    BIGNUM* bn_temp2 = BN_new(); 
-    BN_vec_inner_product(bn_temp1, vec_1_power, vec_y_power); 
-    BN_vec_inner_product(bn_temp2, vec_short_1_power, vec_short_2_power); 
-
-    BIGNUM* bn_c0 = BN_new(); 
-    BN_mod_sub(bn_c0, z, z_square, order, bn_ctx);
-    BN_mul(bn_temp1, bn_c0, bn_temp1, bn_ctx); 
-    BN_mul(bn_temp2, sum_z, bn_temp2, bn_ctx); 
-  
-    BN_mod_sub(delta_yz, bn_temp1, bn_temp2, order, bn_ctx);  //Eq (39)
 
-    EC_POINT* LEFT = EC_POINT_new(group); 
-    EC_POINT* RIGHT = EC_POINT_new(group); 
-    // check Eq (72)  
-    EC_POINT_mul(group, LEFT, proof.taux, pp.h, proof.tx, bn_ctx);  // LEFT = g^{\taux} h^\hat{t}
+    // h_i: weight (y^{-i} (b*s_i^{-1} - z^{j+1} 2^k) - z) for i = (j-1)n + k
+    for (auto j = 1; j <= pp.AGG_NUM; j++)
+    {
+        for (auto k = 0; k < pp.RANGE_LEN; k++)
+        {
+            size_t i = (j-1)*pp.RANGE_LEN + k; 
+            BN_mod_mul(bn_temp1, proof.ip_proof.b, vec_s[IP_LEN-1-i], order, ctx); 
+            BN_mod_mul(bn_temp, vec_adjust_z_power[j], vec_short_2_power[k], order, ctx); 
+            BN_mod_sub(bn_temp1, bn_temp1, bn_temp, order, ctx); 
+            BN_mod_mul(bn_temp1, bn_temp1, vec_y_inverse_power[i], order, ctx); 
+            BN_mod_sub(bn_temp1, bn_temp1, z, order, ctx); 
+            BN_mod_mul(bn_temp1, bn_temp1, weight, order, ctx); 
+            BN_mod_add(terms.vec_h_scalar[i], terms.vec_h_scalar[i], bn_temp1, order, ctx); 
+        }
+    }
+    BN_mod_sub(bn_temp2, z, BN_1, order, ctx); 
+    for (auto i = l; i < IP_LEN; i++) // h_i: weight (y^{-i} b*s_i^{-1} - (z - 1)) on the padding, aR_i = -1 gives the 1 
+    {
+        BN_mod_mul(bn_temp1, proof.ip_proof.b, vec_s[IP_LEN-1-i], order, ctx); 
+        BN_mod_mul(bn_temp1, bn_temp1, vec_y_inverse_power[i], order, ctx); 
+        BN_mod_sub(bn_temp1, bn_temp1, bn_temp2, order, ctx); 
+        BN_mod_mul(bn_temp1, bn_temp1, weight, order, ctx); 
+        BN_mod_add(terms.vec_h_scalar[i], terms.vec_h_scalar[i], bn_temp1, order, ctx); 
+    }
 
-    // the intermediate variables used to compute the right value
-    vector<EC_POINT*> vec_A; 
-    vector<BIGNUM*> vec_a;
-    vec_A.resize(pp.AGG_NUM + 3); 
-    vec_a.resize(pp.AGG_NUM + 3);
+    // u: weight e (ab - tx), h: weight mu + c (tx - delta_yz), g: c taux
+    BN_mod_mul(bn_temp, proof.ip_proof.a, proof.ip_proof.b, order, ctx); 
+    BN_mod_sub(bn_temp, bn_temp, proof.tx, order, ctx); 
+    BN_mod_mul(bn_temp, bn_temp, e, order, ctx); 
+    BN_mod_mul(bn_temp, bn_temp, weight, order, ctx); 
+    BN_mod_add(terms.vec_base_scalar[0], terms.vec_base_scalar[0], bn_temp, order, ctx); 
+    BN_mod_sub(bn_temp, proof.tx, delta_yz, order, ctx); 
+    BN_mod_mul(bn_temp, bn_temp, c, order, ctx); 
+    BN_mod_mul(bn_temp1, proof.mu, weight, order, ctx); 
+    BN_mod_add(bn_temp, bn_temp, bn_temp1, order, ctx); 
+    BN_mod_add(terms.vec_base_scalar[1], terms.vec_base_scalar[1], bn_temp, order, ctx); 
+    BN_mod_mul(bn_temp, c, proof.taux, order, ctx); 
+    BN_mod_add(terms.vec_base_scalar[2], terms.vec_base_scalar[2], bn_temp, order, ctx); 
+
+    // A: -weight, S: -weight x, L_k: -weight x_k^2, R_k: -weight x_k^{-2}
+    Bullet_Verify_Terms_sub(terms, proof.A, weight, BN_1, ctx); 
+    Bullet_Verify_Terms_sub(terms, proof.S, weight, x, ctx); 
+    for (auto k = 0; k < LOG_LEN; k++)
+    {
+        BN_mod_sqr(bn_temp, vec_x[k], order, ctx); 
+        Bullet_Verify_Terms_sub(terms, proof.ip_proof.vec_L[k], weight, bn_temp, ctx); 
+        BN_mod_sqr(bn_temp, vec_x_inverse[k], order, ctx); 
+        Bullet_Verify_Terms_sub(terms, proof.ip_proof.vec_R[k], weight, bn_temp, ctx); 
+    }
 
-    copy(instance.C.begin(), instance.C.end(), vec_A.begin()); 
-    copy(vec_adjust_z_power.begin()+1, vec_adjust_z_power.end(), vec_a.begin()); 
+    // C_j: -c z^{j+1}, T1: -c x, T2: -c x^2
+    for (auto j = 1; j <= pp.AGG_NUM; j++){
+        Bullet_Verify_Terms_sub(terms, instance.C[j-1], c, vec_adjust_z_power[j], ctx); 
+    }
+    Bullet_Verify_Terms_sub(terms, proof.T1, c, x, ctx); 
+    Bullet_Verify_Terms_sub(terms, proof.T2, c, x_square, ctx); 
 
-    vec_A[pp.AGG_NUM] = pp.h, vec_A[pp.AGG_NUM+1] = proof.T1, vec_A[pp.AGG_NUM+2] = proof.T2;
-    vec_a[pp.AGG_NUM] = delta_yz, vec_a[pp.AGG_NUM+1] = x, vec_a[pp.AGG_NUM+2] = x_square;  
+    // free temporary variables
+    BN_free(x), BN_free(x_square); 
+    BN_free(y), BN_free(y_inverse);  
+    BN_free(z), BN_free(z_square); 
+    BN_free(e), BN_free(c); 
+    BN_free(delta_yz); 
+    BN_free(bn_temp), BN_free(bn_temp1), BN_free(bn_temp2); 
 
-    ECP_vec_mul(RIGHT, vec_A, vec_a);  // RIGHT = V^{z^2} h^{\delta_yz} T_1^x T_2^{x^2} 
+    BN_vec_free(vec_x), BN_vec_free(vec_x_inverse); 
+    BN_vec_free(vec_y_power), BN_vec_free(vec_y_inverse_power); 
+    BN_vec_free(vec_short_2_power); 
+    BN_vec_free(vec_adjust_z_power); 
+    BN_vec_free(vec_s); 
 
-    V1 = (EC_POINT_cmp(group, LEFT, RIGHT, bn_ctx) == 0); 
-    #ifdef DEBUG
-    cout << boolalpha << "Condition 1 (Aggregating Log Size BulletProof) = " << V1 << endl; 
-    #endif
+    return true; 
+}
 
-    vector<BIGNUM *> vec_y_inverse_power(l); 
-    BN_vec_new(vec_y_inverse_power); 
-    BN_vec_gen_power(vec_y_inverse_power, y_inverse); // y^nm
-    vector<EC_POINT *> vec_h_new(l); 
-    ECP_vec_new(vec_h_new); 
-    ECP_vec_product(vec_h_new, pp.vec_h, vec_y_inverse_power); 
-
-    //check Eq (66,67,68) using Inner Product Argument
-    InnerProduct_PP ip_pp; 
-    InnerProduct_PP_new(ip_pp, l); 
-    InnerProduct_Setup(ip_pp, l, false); 
-    ECP_vec_copy(ip_pp.vec_g, pp.vec_g);
-    ECP_vec_copy(ip_pp.vec_h, vec_h_new);  
-
-    //InnerProduct_Proof ip_proof = proof.ip_proof;
-    InnerProduct_Instance ip_instance;
-    InnerProduct_Instance_new(ip_instance); 
-    EC_POINT_copy(ip_instance.u, pp.u); 
-    EC_POINT_mul(group, ip_instance.u, NULL, ip_instance.u, e, bn_ctx); // u = u^e 
-    
-    vec_A.clear(); vec_a.clear(); 
-    vec_A.emplace_back(proof.A); vec_A.emplace_back(proof.S); 
-    vec_a.emplace_back(BN_1); vec_a.emplace_back(x); // LEFT = A+S^x
-
-    vector<BIGNUM *> vec_z_minus_unary(l); 
-    BN_vec_new(vec_z_minus_unary); 
-    BN_vec_scalar(vec_z_minus_unary, vec_1_power, z_minus); 
-
-    vec_A.insert(vec_A.end(), ip_pp.vec_g.begin(), ip_pp.vec_g.end()); 
-    vec_a.insert(vec_a.end(), vec_z_minus_unary.begin(), vec_z_minus_unary.end()); // LEFT += g^{-1 z^n} 
-      
-    vector<BIGNUM *> vec_rr(l); 
-    BN_vec_new(vec_rr); 
-    BN_vec_scalar(vec_rr, vec_y_power, z); // z y^nm
-
-    vector<BIGNUM*> temp_vec_zz(l);
-    BN_vec_new(temp_vec_zz); 
-    for(auto j = 1; j <= pp.AGG_NUM; j++)
-    {
-        BN_vec_scalar(temp_vec_zz, vec_2_power, vec_adjust_z_power[j]); 
-        for(auto i = 0; i < pp.RANGE_LEN; i++)
-        {
-            BN_mod_add(vec_rr[(j-1)*pp.RANGE_LEN+i], vec_rr[(j-1)*pp.RANGE_LEN+i], temp_vec_zz[i], order, bn_ctx);            
-        }
+/* check that the combined equation in terms holds */
+bool Bullet_Verify_Terms_check(const Bullet_PP &pp, Bullet_Verify_Terms &terms, 
+                               size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if (pp.table.WINDOW_LEN != 0)
+    {
+        // the shared generators on the fixed-base tables, the points of the proofs by the bucket method 
+        vector<BIGNUM *> vec_a; 
+        vec_a.insert(vec_a.end(), terms.vec_g_scalar.begin(), terms.vec_g_scalar.end()); 
+        vec_a.insert(vec_a.end(), terms.vec_h_scalar.begin(), terms.vec_h_scalar.end()); 
+        vec_a.insert(vec_a.end(), terms.vec_base_scalar.begin(), terms.vec_base_scalar.end()); 
+        BN_CTX *ctx = BN_CTX_new(); 
+        vector<unsigned char> vec_scalar; 
+        MULTIEXP_scalar_bytes(vec_scalar, vec_a, ctx); 
+        size_t l = pp.vec_g.size(); 
+        vector<PointVec_Slice> vec_slice = {PointVec_Table_slice(pp.table, 3, 2*l), PointVec_Table_slice(pp.table, 2, 1), 
+                                            PointVec_Table_slice(pp.table, 1, 1), PointVec_Table_slice(pp.table, 0, 1)}; 
+        EC_POINT *RESULT = EC_POINT_new(group); 
+        EC_POINT *RESULT_proof = EC_POINT_new(group); 
+        PointVec_Table_multiexp(RESULT, vec_slice, vec_scalar, pp.table.WINDOW_LEN, THREAD_NUM); 
+        ECP_vec_mul(RESULT_proof, terms.vec_A, terms.vec_a, THREAD_NUM); 
+        EC_POINT_add(group, RESULT, RESULT, RESULT_proof, ctx); 
+        bool Validity = (EC_POINT_is_at_infinity(group, RESULT) == 1); 
+        EC_POINT_free(RESULT); 
+        EC_POINT_free(RESULT_proof); 
+        BN_CTX_free(ctx); 
+        return Validity; 
     }
 
-    vec_A.insert(vec_A.end(), ip_pp.vec_h.begin(), ip_pp.vec_h.end()); 
-    vec_a.insert(vec_a.end(), vec_rr.begin(), vec_rr.end()); 
+    EC_POINT *g = EC_POINT_new(group); 
+    EC_POINT_copy(g, generator); 
 
-    BN_mod_negative(proof.mu); 
-    vec_A.emplace_back(pp.h); vec_A.emplace_back(ip_instance.u); 
-    vec_a.emplace_back(proof.mu); vec_a.emplace_back(proof.tx); 
-    ECP_vec_mul(ip_instance.P, vec_A, vec_a);  // set P_new = P h^{-u} U^<l, r>   
+    vector<EC_POINT *> vec_A; 
+    vector<BIGNUM *> vec_a; 
+    vec_A.insert(vec_A.end(), pp.vec_g.begin(), pp.vec_g.end()); 
+    vec_A.insert(vec_A.end(), pp.vec_h.begin(), pp.vec_h.end()); 
+    vec_A.emplace_back(pp.u); vec_A.emplace_back(pp.h); vec_A.emplace_back(g); 
+    vec_A.insert(vec_A.end(), terms.vec_A.begin(), terms.vec_A.end()); 
+    vec_a.insert(vec_a.end(), terms.vec_g_scalar.begin(), terms.vec_g_scalar.end()); 
+    vec_a.insert(vec_a.end(), terms.vec_h_scalar.begin(), terms.vec_h_scalar.end()); 
+    vec_a.insert(vec_a.end(), terms.vec_base_scalar.begin(), terms.vec_base_scalar.end()); 
+    vec_a.insert(vec_a.end(), terms.vec_a.begin(), terms.vec_a.end()); 
+
+    EC_POINT *RESULT = EC_POINT_new(group); 
+    ECP_vec_mul(RESULT, vec_A, vec_a, THREAD_NUM); 
+    bool Validity = (EC_POINT_is_at_infinity(group, RESULT) == 1); 
+
+    EC_POINT_free(g); 
+    EC_POINT_free(RESULT); 
+    return Validity; 
+}
 
-    transcript_str += ECP_ep2string(ip_instance.P) + ECP_ep2string(ip_instance.u); 
-    V2 = InnerProduct_Verify(ip_pp, ip_instance, transcript_str, proof.ip_proof); 
+/* 
+    reentrant: pp, instance, transcript_str and proof are only read, and all temporaries live in ctx and the call, 
+    so threads can verify shared proofs at once if each passes its own BN_CTX (the default bn_ctx is not thread-safe) 
+    THREAD_NUM bounds the threads of the final multi-exponentiation, a pool of verifiers would pass 1 
+*/
+bool Bullet_Verify(const Bullet_PP &pp, const Bullet_Instance &instance, const string &transcript_str, 
+                   const Bullet_Proof &proof, BN_CTX *ctx = bn_ctx, size_t THREAD_NUM = thread::hardware_concurrency())
+{
     #ifdef DEBUG
-    cout << boolalpha << "Condition 2 (Aggregating Log Size BulletProof) = " << V2 << endl; 
+        cout << "begin to check the proof" << endl; 
     #endif
 
-    Validity = V1 && V2;     
+    Bullet_Verify_Terms terms; 
+    Bullet_Verify_Terms_new(pp, terms); 
+    bool Validity = Bullet_Verify_add(pp, instance, transcript_str, proof, BN_1, terms, ctx) 
+                    && Bullet_Verify_Terms_check(pp, terms, THREAD_NUM); 
+    Bullet_Verify_Terms_free(terms); 
+
     #ifdef DEBUG
     if (Validity) 
     { 
@@ -640,29 +1009,41 @@ bool Bullet_Verify(Bullet_PP &pp, Bullet_Instance &instance, string &transcript_
     }
     #endif
 
-    // free temporary variables
-    BN_vec_free(vec_1_power), BN_vec_free(vec_short_1_power);
-    BN_vec_free(vec_2_power), BN_vec_free(vec_short_2_power); 
-
-    BN_free(x), BN_free(x_square); 
-    BN_free(y), BN_free(y_inverse);  
-    BN_vec_free(vec_y_power), BN_vec_free(vec_y_inverse_power); 
-    BN_free(z), BN_free(z_minus), BN_free(z_square), BN_free(z_cubic); 
-    BN_vec_free(vec_adjust_z_power), BN_vec_free(vec_z_minus_unary); 
-    BN_free(e); 
-    BN_free(sum_z); 
-    BN_free(delta_yz); 
-
-    ECP_vec_free(vec_h_new); 
+    return Validity; 
+}
 
-    BN_free(bn_c0), BN_free(bn_temp0), BN_free(bn_temp1), BN_free(bn_temp2); 
+/* 
+    check the proofs vec_proof[k] for vec_instance[k] with the initial transcripts vec_transcript_str[k] at once: 
+    true iff all proofs are valid (except with negligible probability); a false batch can be rechecked one by one 
+    reentrant in the same way as Bullet_Verify 
+*/
+bool Bullet_Batch_Verify(const Bullet_PP &pp, const vector<Bullet_Instance> &vec_instance, 
+                         const vector<string> &vec_transcript_str, const vector<Bullet_Proof> &vec_proof, 
+                         BN_CTX *ctx = bn_ctx, size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if(vec_instance.size() != vec_proof.size() || vec_transcript_str.size() != vec_proof.size())
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE); 
+    }
 
-    BN_vec_free(vec_rr); 
-    BN_vec_free(temp_vec_zz); 
+    Bullet_Verify_Terms terms; 
+    Bullet_Verify_Terms_new(pp, terms); 
+    BIGNUM *weight = BN_new(); 
+    bool Validity = true; 
+    for (auto k = 0; k < vec_proof.size() && Validity; k++)
+    {
+        BN_random(weight); 
+        Validity = Bullet_Verify_add(pp, vec_instance[k], vec_transcript_str[k], vec_proof[k], weight, terms, ctx); 
+    }
+    if (Validity) Validity = Bullet_Verify_Terms_check(pp, terms, THREAD_NUM); 
 
-    InnerProduct_PP_free(ip_pp); 
-    InnerProduct_Instance_free(ip_instance); 
+    #ifdef DEBUG
+    cout << boolalpha << "batch of " << vec_proof.size() << " BulletProofs accepts = " << Validity << endl; 
+    #endif
 
+    BN_free(weight); 
+    Bullet_Verify_Terms_free(terms); 
     return Validity; 
 }
 
@@ -0,0 +1,75 @@
+/***********************************************************************************
+this hpp implements the aggregated logarithmic size proof that twisted ElGamal ciphertexts encrypt bits
+************************************************************************************
+* @author     This file is part of PGC, developed by Yu Chen
+* @paper      https://eprint.iacr.org/2019/319
+* @copyright  MIT license (see LICENSE file)
+***********************************************************************************/
+#ifndef __BIT__
+#define __BIT__
+#include "aggregate_bulletproof.hpp"
+#include "../twisted_elgamal/twisted_elgamal.hpp"
+
+/*
+    Y = g^r h^m of a twisted ElGamal ciphertext is a Pedersen commitment to m under the g, h of Bullet_Setup, so
+    "m_j \in {0, 1} for every ciphertext" is the aggregated Bulletproof with RANGE_LEN = 1 and AGG_NUM = N:
+    2 log(N) + 4 points and 5 scalars (N is padded to a power of 2 inside), instead of N Sigma OR-proofs
+    with 4 points and 4 scalars each.
+    Only Y is proven: that X = pk^r uses the same r is left to the validity proof of the ciphertext,
+    and the caller binds pk, X or any other context through transcript_str.
+*/
+
+/* allocate the pp for proofs over BIT_NUM ciphertexts */
+void Bit_PP_new(Bullet_PP &pp, size_t BIT_NUM)
+{
+    size_t RANGE_LEN = 1;
+    Bullet_PP_new(pp, RANGE_LEN, BIT_NUM);
+}
+
+/* derive the pp from SEED, with the g, h of the twisted ElGamal pp */
+void Bit_Setup(Bullet_PP &pp, Twisted_ElGamal_PP &pp_tt, size_t BIT_NUM, string SEED = BULLET_SEED)
+{
+    size_t RANGE_LEN = 1;
+    Bullet_Setup(pp, RANGE_LEN, BIT_NUM, SEED);
+    EC_POINT_copy(pp.g, pp_tt.g);
+    EC_POINT_copy(pp.h, pp_tt.h);
+}
+
+/* the Bulletproof instance of vec_CT: it borrows the Y points, so it must not be freed */
+inline void Bit_Instance(Bullet_Instance &instance, const vector<Twisted_ElGamal_CT> &vec_CT)
+{
+    instance.C.resize(vec_CT.size());
+    for (auto j = 0; j < vec_CT.size(); j++) instance.C[j] = vec_CT[j].Y;
+}
+
+/* prove that vec_CT[j] = Enc(pk, vec_m[j]; vec_r[j]) encrypts a bit for every j */
+void Bit_Prove(Bullet_PP &pp, const vector<Twisted_ElGamal_CT> &vec_CT,
+               vector<BIGNUM *> &vec_r, vector<BIGNUM *> &vec_m,
+               string &transcript_str, Bullet_Proof &proof,
+               size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if (pp.RANGE_LEN != 1 || vec_CT.size() != pp.AGG_NUM || vec_r.size() != pp.AGG_NUM || vec_m.size() != pp.AGG_NUM)
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Bullet_Instance instance;
+    Bit_Instance(instance, vec_CT);
+    Bullet_Witness witness;
+    witness.r = vec_r;
+    witness.v = vec_m;
+    Bullet_Prove(pp, instance, witness, transcript_str, proof, THREAD_NUM);
+}
+
+/* check the proof that every ciphertext of vec_CT encrypts a bit: reentrant in the same way as Bullet_Verify */
+bool Bit_Verify(const Bullet_PP &pp, const vector<Twisted_ElGamal_CT> &vec_CT, const string &transcript_str,
+                const Bullet_Proof &proof, BN_CTX *ctx = bn_ctx, size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if (pp.RANGE_LEN != 1) return false;
+    Bullet_Instance instance;
+    Bit_Instance(instance, vec_CT);
+    return Bullet_Verify(pp, instance, transcript_str, proof, ctx, THREAD_NUM);
+}
+
+#endif
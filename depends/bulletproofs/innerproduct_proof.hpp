@@ -12,6 +12,9 @@ this hpp implements the inner product proof system
 #include "../common/hash.hpp"
 #include "../common/print.hpp"
 #include "../common/routines.hpp"
+#include "../common/multiexp.hpp"
+#include "../common/parallel.hpp"
+#include "../common/scalar.hpp"
 
 // define the structure of InnerProduct Proof
 struct InnerProduct_PP
@@ -184,12 +187,12 @@ inline uint64_t int_parse_binary(size_t num, size_t j, size_t m)
 }
 
 /* generate a^n = (a^0, a^1, a^2, ..., a^{n-1}) */ 
-inline void BN_vec_gen_power(vector<BIGNUM *> &result, BIGNUM *&a)
+inline void BN_vec_gen_power(vector<BIGNUM *> &result, const BIGNUM *a, BN_CTX *ctx = bn_ctx)
 {
     BN_one(result[0]); // set result[0] = 1
     for (auto i = 1; i < result.size(); i++)
     {
-        BN_mod_mul(result[i], a, result[i-1], order, bn_ctx); // result[i] = result[i-1]*a % order
+        BN_mod_mul(result[i], a, result[i-1], order, ctx); // result[i] = result[i-1]*a % order
     }
 }
 
@@ -294,13 +297,10 @@ inline void BN_vec_product(vector<BIGNUM *> &result, vector<BIGNUM *> &vec_a, ve
     }
 }
 
-/* compute the inverse of a[i] */ 
+/* compute the inverse of a[i] with one modular inversion (Montgomery's trick) */ 
 inline void BN_vec_inverse(vector<BIGNUM *> &vec_a_inverse, vector<BIGNUM *> &vec_a)
 {
-    for (auto i = 0; i < vec_a.size(); i++) 
-    {
-        BN_mod_inverse(vec_a_inverse[i], vec_a[i], order, bn_ctx); 
-    }
+    BN_vec_batch_inverse(vec_a_inverse, vec_a); 
 }
 
 /* vec_g = c * vec_g */ 
@@ -344,46 +344,58 @@ inline void ECP_vec_product(vector<EC_POINT *> &result, vector<EC_POINT *> &vec_
     } 
 }
 
-/* result = sum_{i=1^n} a[i]*A[i] */ 
-inline void ECP_vec_mul(EC_POINT* &result, vector<EC_POINT *> &vec_A, vector<BIGNUM *> &vec_a)
+/* result = sum_{i=1^n} a[i]*A[i]: the bucket method for long inputs, EC_POINTs_mul otherwise */ 
+inline void ECP_vec_mul(EC_POINT* &result, const vector<EC_POINT *> &vec_A, const vector<BIGNUM *> &vec_a, 
+                        size_t THREAD_NUM = thread::hardware_concurrency())
 {
-    if (vec_A.size() != vec_a.size()) {
-        cout << "vector size does not match!" << endl;
-        exit(EXIT_FAILURE); 
-    }
-    EC_POINTs_mul(group, result, NULL, vec_A.size(), 
-                  (const EC_POINT**)vec_A.data(), (const BIGNUM**)vec_a.data(), bn_ctx); 
+    ECP_multiexp(result, vec_A, vec_a, THREAD_NUM); 
 }
 
-/* this module is used to enable fast verification (cf pp.15) */
-void compute_vec_ss(vector<BIGNUM *> &vec_s, vector<BIGNUM *> &vec_x, vector<BIGNUM *> &vec_x_inverse)
+/* 
+    this module is used to enable fast verification (cf pp.15) 
+    s_i = prod_j x_j^{b(i,j)} with b(i,j) = +1 if the jth bit of i (from big endian) is 1, and -1 otherwise 
+    built in O(n) by doubling: s_0 = prod_j x_j^{-1}, and s_{i + 2^k} = s_i x_{m-1-k}^2 for i < 2^k 
+    since s_{n-1-i} = s_i^{-1}, the inverse vector is vec_s read backwards 
+*/
+void compute_vec_ss(vector<BIGNUM *> &vec_s, const vector<BIGNUM *> &vec_x, const vector<BIGNUM *> &vec_x_inverse, 
+                    BN_CTX *ctx = bn_ctx)
 {
     size_t m = vec_x.size(); 
-    size_t n = vec_s.size(); //int n = pow(2, m); 
-    
-    // compute s[0], ..., s[i-1]
-    // vector<BIGNUM *> vec_s(n); 
-    uint64_t flag; 
-    for (auto i = 0; i < n; i++)
+    size_t n = vec_s.size(); // n = 2^m 
+    if (n != (size_t(1) << m) || vec_x_inverse.size() != m)
     {
-        BN_one(vec_s[i]); // set s[i] = 1
-        for (auto j = 0; j < m; j++)
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE); 
+    }
+
+    BN_one(vec_s[0]); 
+    for (auto j = 0; j < m; j++)
+    {
+        BN_mod_mul(vec_s[0], vec_s[0], vec_x_inverse[j], order, ctx); 
+    }
+
+    BIGNUM *x_square = BN_new(); 
+    for (auto k = 0; k < m; k++)
+    {
+        size_t half = size_t(1) << k; 
+        BN_mod_sqr(x_square, vec_x[m-1-k], order, ctx); 
+        for (auto i = 0; i < half; i++)
         {
-            flag = int_parse_binary(i, j, m); 
-            if (flag == 1){
-                BN_mod_mul(vec_s[i], vec_s[i], vec_x[j], order, bn_ctx);
-            } 
-            else{
-                BN_mod_mul(vec_s[i], vec_s[i], vec_x_inverse[j], order, bn_ctx);
-            } 
+            BN_mod_mul(vec_s[half+i], vec_s[i], x_square, order, ctx);
         }
     }
+    BN_free(x_square); 
 } 
 
 
 /* (Protocol 2 on pp.15) */
 void InnerProduct_Setup(InnerProduct_PP &pp, size_t VECTOR_LEN, bool INITIAL_FLAG)
 {
+    if (VECTOR_LEN == 0 || (VECTOR_LEN & (VECTOR_LEN-1)) != 0)
+    {
+        cout << "the vector length of the inner product argument must be a power of 2" << endl; 
+        exit(EXIT_FAILURE); 
+    }
     pp.VECTOR_LEN = VECTOR_LEN;
     pp.LOG_VECTOR_LEN = log2(VECTOR_LEN);  
 
@@ -394,181 +406,186 @@ void InnerProduct_Setup(InnerProduct_PP &pp, size_t VECTOR_LEN, bool INITIAL_FLA
 }
 
 /* 
-    Generate an argument PI for Relation 3 on pp.13: P = g^a h^b u^<a,b> 
-    transcript_str is introduced to be used as a sub-protocol 
+    The rounds of the inner product argument on working buffers: vec_g, vec_h (affine PointVecs) and 
+    vec_a, vec_b (Montgomery scalars) are folded in place into their first n/2 entries in round k, 
+    so nothing is allocated per round, and the left and right halves are slices of the same buffers. 
+    The buffers are consumed. The folded P is not needed by the prover and is not computed. 
+    The per-element work of each round is split over THREAD_NUM threads. Besides the inputs, the rounds only 
+    keep one byte buffer of n+1 exponents, shared by L and R, and Jacobian blocks of INNERPRODUCT_FOLD_BLOCK points. 
 */
-void InnerProduct_Prove(InnerProduct_PP pp, 
-                        InnerProduct_Instance instance, 
-                        InnerProduct_Witness witness,
-                        string &transcript_str,  
-                        InnerProduct_Proof &proof)
+const size_t INNERPRODUCT_FOLD_BLOCK = 256; // the folded generators are normalized with one inversion per block 
+
+void InnerProduct_Prove_Rounds(PointVec &vec_g, PointVec &vec_h, const Affine_Point &u, 
+                               ScalarVec &vec_a, ScalarVec &vec_b, 
+                               string &transcript_str, 
+                               InnerProduct_Proof &proof, 
+                               size_t THREAD_NUM = thread::hardware_concurrency())
 {
-    if (pp.vec_g.size()!=pp.vec_h.size()) 
+    size_t n = vec_g.size(); // the current size of vec_g and vec_h
+    if (vec_h.size() != n || vec_a.size() != n || vec_b.size() != n) 
     {
-        cout << "vector size does not match!";
+        cout << "vector size does not match!" << endl;
         exit(EXIT_FAILURE); 
     }
-
-    size_t n = pp.VECTOR_LEN; // the current size of vec_G and vec_H
-
-    // the last round
-    if (n == 1)
+    if (n == 0 || (n & (n-1)) != 0)
     {
-        BN_copy(proof.a, witness.vec_a[0]);
-        BN_copy(proof.b, witness.vec_b[0]); 
- 
-        #ifdef DEBUG
-        cout<< "Inner Product Proof Generation Finishes >>>" << endl;
-        #endif 
-
-        return; 
+        cout << "the vector length of the inner product argument must be a power of 2" << endl; 
+        exit(EXIT_FAILURE); 
     }
-    else{
-        n = n/2; 
-    
-        // prepare the log(n)-th round message
-        vector<BIGNUM*> vec_aL(n), vec_aR(n), vec_bL(n), vec_bR(n);
-        BN_vec_new(vec_aL); 
-        BN_vec_new(vec_aR); 
-        BN_vec_new(vec_bL); 
-        BN_vec_new(vec_bR);  
-        
-        vector<EC_POINT*> vec_gL(n), vec_gR(n), vec_hL(n), vec_hR(n);
-        ECP_vec_new(vec_gL); 
-        ECP_vec_new(vec_gR); 
-        ECP_vec_new(vec_hL); 
-        ECP_vec_new(vec_hR);  
-
-        // prepare aL, aR, bL, bR
-        BN_vec_assign(vec_aL, witness.vec_a, "left");
-        BN_vec_assign(vec_aR, witness.vec_a, "right"); 
-        BN_vec_assign(vec_bL, witness.vec_b, "left"); 
-        BN_vec_assign(vec_bR, witness.vec_b, "right");
-
-        ECP_vec_assign(vec_gL, pp.vec_g, "left"); 
-        ECP_vec_assign(vec_gR, pp.vec_g, "right"); 
-        ECP_vec_assign(vec_hL, pp.vec_h, "left"); 
-        ECP_vec_assign(vec_hR, pp.vec_h, "right");
-
-        // compute cL, cR
-        BIGNUM *cL = BN_new(); 
-        BN_vec_inner_product(cL, vec_aL, vec_bR); // Eq (21) 
-        BIGNUM *cR = BN_new(); 
-        BN_vec_inner_product(cR, vec_aR, vec_bL); // Eq (22)
-
-        // compute L, R
-        EC_POINT *temp_ecpsum  = EC_POINT_new(group);         
-        EC_POINT *temp_ecp1 = EC_POINT_new(group); 
-        EC_POINT *temp_ecp2 = EC_POINT_new(group); 
-
-        vector<EC_POINT *> vec_A; 
-        vector<BIGNUM *> vec_a; 
 
-        EC_POINT *L = EC_POINT_new(group); 
+    PointVec vec_u(1, u); 
+    vector<unsigned char> vec_scalar((n+1)*BN_LEN); // the exponents of L, then of R 
 
-        vec_A.insert(vec_A.end(), vec_gR.begin(), vec_gR.end()); 
-        vec_A.insert(vec_A.end(), vec_hL.begin(), vec_hL.end());
-        vec_A.emplace_back(instance.u); 
+    BIGNUM *x = BN_new(); 
+    BIGNUM *x_inverse = BN_new(); 
+    Scalar S_x, S_x_inverse, S_cL, S_cR; 
+    unsigned char x_bytes[BN_LEN], x_inverse_bytes[BN_LEN]; 
+    if (THREAD_NUM == 0) THREAD_NUM = 1; 
+    ScalarVec vec_cL_partial(THREAD_NUM), vec_cR_partial(THREAD_NUM); // per-thread partial sums
 
-        vec_a.insert(vec_a.end(), vec_aL.begin(), vec_aL.end()); 
-        vec_a.insert(vec_a.end(), vec_bR.begin(), vec_bR.end());
-        vec_a.emplace_back(cL); 
+    while (n > 1)
+    {
+        n = n/2; 
 
-        ECP_vec_mul(L, vec_A, vec_a);  // Eq (23) 
+        // compute cL = <aL, bR>, cR = <aR, bL> Eq (21, 22)
+        for (auto t = 0; t < THREAD_NUM; t++)
+        {
+            Scalar_zero(vec_cL_partial[t]); 
+            Scalar_zero(vec_cR_partial[t]); 
+        }
+        Parallel_For(n, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+        {
+            ScalarVec_inner_product(vec_cL_partial[t], &vec_a[start], &vec_b[n+start], end - start); 
+            ScalarVec_inner_product(vec_cR_partial[t], &vec_a[n+start], &vec_b[start], end - start); 
+        }, THREAD_NUM); 
+        Scalar_zero(S_cL); 
+        Scalar_zero(S_cR); 
+        for (auto t = 0; t < THREAD_NUM; t++)
+        {
+            Scalar_add(S_cL, S_cL, vec_cL_partial[t]); 
+            Scalar_add(S_cR, S_cR, vec_cR_partial[t]); 
+        }
+        vec_scalar.resize((2*n+1)*BN_LEN); 
 
-        vec_A.clear(); vec_a.clear(); 
+        // L = gR^aL hL^bR u^cL  Eq (23) 
+        Parallel_For(n, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+        {
+            for (auto i = start; i < end; i++)
+            {
+                Scalar_to_bytes(&vec_scalar[i*BN_LEN], vec_a[i]); 
+                Scalar_to_bytes(&vec_scalar[(n+i)*BN_LEN], vec_b[n+i]); 
+            }
+        }, THREAD_NUM); 
+        Scalar_to_bytes(&vec_scalar[2*n*BN_LEN], S_cL); 
+        EC_POINT *L = EC_POINT_new(group); 
+        vector<PointVec_Slice> vec_slice = {PointVec_slice(vec_g, n, n), PointVec_slice(vec_h, 0, n), PointVec_slice(vec_u, 0, 1)}; 
+        PointVec_multiexp(L, vec_slice, vec_scalar, 8*BN_LEN, THREAD_NUM); 
 
+        // R = gL^aR hR^bL u^cR  Eq (24)
+        Parallel_For(n, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+        {
+            for (auto i = start; i < end; i++)
+            {
+                Scalar_to_bytes(&vec_scalar[i*BN_LEN], vec_a[n+i]); 
+                Scalar_to_bytes(&vec_scalar[(n+i)*BN_LEN], vec_b[i]); 
+            }
+        }, THREAD_NUM); 
+        Scalar_to_bytes(&vec_scalar[2*n*BN_LEN], S_cR); 
         EC_POINT *R = EC_POINT_new(group); 
-
-        vec_A.insert(vec_A.end(), vec_gL.begin(), vec_gL.end()); 
-        vec_A.insert(vec_A.end(), vec_hR.begin(), vec_hR.end());
-        vec_A.emplace_back(instance.u); 
-
-        vec_a.insert(vec_a.end(), vec_aR.begin(), vec_aR.end()); 
-        vec_a.insert(vec_a.end(), vec_bL.begin(), vec_bL.end());
-        vec_a.emplace_back(cR); 
-
-        ECP_vec_mul(R, vec_A, vec_a);  // Eq (24)
+        vec_slice = {PointVec_slice(vec_g, 0, n), PointVec_slice(vec_h, n, n), PointVec_slice(vec_u, 0, 1)}; 
+        PointVec_multiexp(R, vec_slice, vec_scalar, 8*BN_LEN, THREAD_NUM); 
 
         proof.vec_L.push_back(L); 
         proof.vec_R.push_back(R);  // store the n-th round L and R values
 
-        // compute the challenge
+        // compute the challenge Eq (26,27)
         transcript_str += ECP_ep2string(L) + ECP_ep2string(R); 
-        BIGNUM *x = BN_new(); 
-        Hash_String_to_BN(transcript_str, x); // compute the n-th round challenge Eq (26,27)
-        BIGNUM *x_inverse = BN_new(); 
+        Hash_String_to_BN(transcript_str, x); 
         BN_mod_inverse(x_inverse, x, order, bn_ctx);  
+        Scalar_from_BN(S_x, x, bn_ctx); 
+        Scalar_from_BN(S_x_inverse, x_inverse, bn_ctx); 
+        BN_bn2binpad(x, x_bytes, BN_LEN); 
+        BN_bn2binpad(x_inverse, x_inverse_bytes, BN_LEN); 
+
+        // fold the witness: a = x aL + x^{-1} aR, b = x^{-1} bL + x bR  Eq (33, 34)
+        // and the generators with 2-term multi-exponentiations: g = gL^{x^{-1}} gR^x, h = hL^x hR^{x^{-1}}  Eq (29, 30)
+        // (the generators of the last round are never used)
+        bool FOLD_GENERATORS = (n > 1); 
+        Parallel_For(n, [&](size_t t, size_t start, size_t end, BN_CTX *ctx)
+        {
+            Scalar temp; 
+            for (auto i = start; i < end; i++)
+            {
+                Scalar_mul(vec_a[i], vec_a[i], S_x); 
+                Scalar_mul(temp, vec_a[n+i], S_x_inverse); 
+                Scalar_add(vec_a[i], vec_a[i], temp); 
+                Scalar_mul(vec_b[i], vec_b[i], S_x_inverse); 
+                Scalar_mul(temp, vec_b[n+i], S_x); 
+                Scalar_add(vec_b[i], vec_b[i], temp); 
+            }
+            if (FOLD_GENERATORS == false) return; 
+
+            vector<Jacobian_Point> vec_fold(min(end - start, INNERPRODUCT_FOLD_BLOCK)); 
+            for (auto block = start; block < end; block += INNERPRODUCT_FOLD_BLOCK)
+            {
+                size_t block_len = min(end - block, INNERPRODUCT_FOLD_BLOCK); 
+                for (auto i = block; i < block + block_len; i++)
+                {
+                    Jacobian_mul2(vec_fold[i-block], vec_g[i], x_inverse_bytes, vec_g[n+i], x_bytes); 
+                }
+                Jacobian_vec_normalize(&vec_g[block], vec_fold.data(), block_len); 
+                for (auto i = block; i < block + block_len; i++)
+                {
+                    Jacobian_mul2(vec_fold[i-block], vec_h[i], x_bytes, vec_h[n+i], x_inverse_bytes); 
+                }
+                Jacobian_vec_normalize(&vec_h[block], vec_fold.data(), block_len); 
+            }
+        }, THREAD_NUM); 
+    }
 
-        // generate new pp
-        InnerProduct_PP pp_sub;
-        // pp_sub.VECTOR_LEN = pp.VECTOR_LEN/2; 
-        // pp_sub.LOG_VECTOR_LEN = pp.LOG_VECTOR_LEN - 1; 
-        InnerProduct_PP_new(pp_sub, pp.VECTOR_LEN/2); 
-        InnerProduct_Setup(pp_sub, pp.VECTOR_LEN/2, false);
-
-        // compute vec_g
-        ECP_vec_scalar(vec_gL, vec_gL, x_inverse); 
-        ECP_vec_scalar(vec_gR, vec_gR, x); 
-        ECP_vec_add(pp_sub.vec_g, vec_gL, vec_gR); // Eq (29)
-        // compute vec_h
-        ECP_vec_scalar(vec_hL, vec_hL, x); 
-        ECP_vec_scalar(vec_hR, vec_hR, x_inverse); 
-        ECP_vec_add(pp_sub.vec_h, vec_hL, vec_hR); // Eq (30)
-
-        // generate new instance
-        InnerProduct_Instance instance_sub; 
-        InnerProduct_Instance_new(instance_sub); 
-
-        EC_POINT_copy(instance_sub.u, instance.u); // instance_new.u = instance.u 
- 
-        BIGNUM *x_square = BN_new(); 
-        BIGNUM *x_inverse_square = BN_new(); 
-        BN_mod_sqr(x_square, x, order, bn_ctx); // vec_x[0] = x^2 mod q
-        BN_mod_sqr(x_inverse_square, x_inverse, order, bn_ctx); // vec_x[0] = x^2 mod q
-
-        vec_A.clear(); vec_a.clear(); 
-        vec_A.resize(3); vec_a.resize(3);
-        vec_A[0] = L; vec_A[1] = instance.P; vec_A[2] = R; 
-        vec_a[0] = x_square; vec_a[1] = BN_1; vec_a[2] = x_inverse_square; 
-
-        ECP_vec_mul(instance_sub.P, vec_A, vec_a); // Eq (31) P' = L^{x^2} P R^{x^{-2}}
-
-        // generate new witness
-        InnerProduct_Witness witness_sub; 
-        InnerProduct_Witness_new(witness_sub, pp_sub.VECTOR_LEN); 
-    
-        BN_vec_scalar(vec_aL, vec_aL, x); 
-        BN_vec_scalar(vec_aR, vec_aR, x_inverse); 
-        BN_vec_add(witness_sub.vec_a, vec_aL, vec_aR); // Eq (33)
-
-        BN_vec_scalar(vec_bL, vec_bL, x_inverse); 
-        BN_vec_scalar(vec_bR, vec_bR, x); 
-        BN_vec_add(witness_sub.vec_b, vec_bL, vec_bR); // Eq (34)
-
-        // recursively invoke the InnerProduct proof
-        InnerProduct_Prove(pp_sub, instance_sub, witness_sub, transcript_str, proof); 
-        //cout << "begin to free " << n << " memory" << endl; 
-        InnerProduct_PP_free(pp_sub); 
-        InnerProduct_Instance_free(instance_sub);
-        InnerProduct_Witness_free(witness_sub);  
-
-        // free temporary variables
-        BN_free(cL); 
-        BN_free(cR);
-        BN_free(x), BN_free(x_inverse); 
-        BN_free(x_square), BN_free(x_inverse_square); 
-
-        BN_vec_free(vec_aL); 
-        BN_vec_free(vec_aR); 
-        BN_vec_free(vec_bL); 
-        BN_vec_free(vec_bR);  
-        
-        ECP_vec_free(vec_gL); 
-        ECP_vec_free(vec_gR); 
-        ECP_vec_free(vec_hL); 
-        ECP_vec_free(vec_hR);  
+    // the last round
+    Scalar_to_BN(proof.a, vec_a[0]);
+    Scalar_to_BN(proof.b, vec_b[0]); 
+
+    #ifdef DEBUG
+    cout<< "Inner Product Proof Generation Finishes >>>" << endl;
+    #endif 
+
+    BN_free(x), BN_free(x_inverse); 
+}
+
+/* 
+    Generate an argument PI for Relation 3 on pp.13: P = g^a h^b u^<a,b> 
+    transcript_str is introduced to be used as a sub-protocol 
+    pp, instance and witness are copied into the working buffers of InnerProduct_Prove_Rounds 
+*/
+void InnerProduct_Prove(InnerProduct_PP &pp, 
+                        InnerProduct_Instance &instance, 
+                        InnerProduct_Witness &witness,
+                        string &transcript_str,  
+                        InnerProduct_Proof &proof, 
+                        size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if (pp.vec_g.size()!=pp.vec_h.size()) 
+    {
+        cout << "vector size does not match!";
+        exit(EXIT_FAILURE); 
     }
+
+    PointVec vec_g, vec_h; 
+    PointVec_from_ECP(vec_g, pp.vec_g, bn_ctx); 
+    PointVec_from_ECP(vec_h, pp.vec_h, bn_ctx); 
+    Affine_Point u; 
+    BIGNUM *x = BN_new(); 
+    BIGNUM *y = BN_new(); 
+    Affine_from_ECP(u, instance.u, x, y, bn_ctx); 
+    BN_free(x), BN_free(y); 
+
+    ScalarVec vec_a, vec_b; 
+    ScalarVec_from_BN(vec_a, witness.vec_a, bn_ctx); 
+    ScalarVec_from_BN(vec_b, witness.vec_b, bn_ctx); 
+
+    InnerProduct_Prove_Rounds(vec_g, vec_h, u, vec_a, vec_b, transcript_str, proof, THREAD_NUM); 
 }
 
 /* Check if PI is a valid proof for inner product statement (G1^w = H1 and G2^w = H2) */
@@ -596,7 +613,10 @@ bool InnerProduct_Verify(InnerProduct_PP &pp,
         Hash_String_to_BN(transcript_str, vec_x[i]); // reconstruct the challenge
 
         BN_mod_sqr(vec_x_square[i], vec_x[i], order, bn_ctx); 
-        BN_mod_inverse(vec_x_inverse[i], vec_x[i], order, bn_ctx);  
+    }
+    BN_vec_batch_inverse(vec_x_inverse, vec_x); 
+    for (auto i = 0; i < pp.LOG_VECTOR_LEN; i++)
+    {  
         BN_mod_sqr(vec_x_inverse_square[i], vec_x_inverse[i], order, bn_ctx); 
     }
 
@@ -611,7 +631,10 @@ bool InnerProduct_Verify(InnerProduct_PP &pp,
     BN_vec_new(vec_s_inverse); 
 
     compute_vec_ss(vec_s, vec_x, vec_x_inverse); // page 15: the s vector
-    BN_vec_inverse(vec_s_inverse, vec_s);  // the s^{-1} vector
+    for (auto i = 0; i < pp.VECTOR_LEN; i++)
+    {
+        BN_copy(vec_s_inverse[i], vec_s[pp.VECTOR_LEN-1-i]);  // the s^{-1} vector: s_i^{-1} = s_{n-1-i}
+    }
     BN_vec_scalar(vec_s, vec_s, proof.a); 
     BN_vec_scalar(vec_s_inverse, vec_s_inverse, proof.b); 
 
@@ -18,6 +18,7 @@ int curve_id = NID_secp256k1
 
 #include <iostream>
 #include <string>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <cmath>
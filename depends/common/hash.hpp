@@ -9,12 +9,13 @@ this hpp implements hash functions
 #define __HASH__
 
 #include "global.hpp"
+#include <atomic>
 
 /* global variables of hash functions */
 const size_t HASH_OUTPUT_LEN = 32;  // hash output = 256-bit string
 
 /* H(str) mod q: map a string to a big integer */
-void Hash_String_to_BN(string &str, BIGNUM *&y)
+void Hash_String_to_BN(const string &str, BIGNUM *y, BN_CTX *ctx = bn_ctx)
 { 
     unsigned char hash_output[HASH_OUTPUT_LEN]; 
  
@@ -25,7 +26,7 @@ void Hash_String_to_BN(string &str, BIGNUM *&y)
     SHA256(reinterpret_cast<unsigned char *>(buffer), str.size(), hash_output);
 
     BN_bin2bn(hash_output, HASH_OUTPUT_LEN, y);
-    BN_nnmod(y, y, order, bn_ctx);
+    BN_nnmod(y, y, order, ctx);
 }
 
 void Hash_BN_to_BN(BIGNUM *&str, BIGNUM *&y)
@@ -66,5 +67,134 @@ void Hash_ECP_to_ECP(EC_POINT *&g, EC_POINT *&h)
     } 
 }
 
+/* the message len(domain) || domain || index || counter of Hash_to_Curve, integers in big endian, counter = 0 */
+string Hash_to_Curve_message(const string &domain, uint64_t index)
+{
+    string message(8 + domain.size() + 8 + 4, 0); 
+    for(auto k = 0; k < 8; k++) message[k] = (uint64_t(domain.size()) >> (56 - 8*k)) & 0xFF; 
+    memcpy(&message[8], domain.data(), domain.size()); 
+    for(auto k = 0; k < 8; k++) message[8 + domain.size() + k] = (index >> (56 - 8*k)) & 0xFF; 
+    return message; 
+}
+
+inline void Hash_to_Curve_set_counter(string &message, uint32_t counter)
+{
+    for(auto k = 0; k < 4; k++) message[message.size() - 4 + k] = (counter >> (24 - 8*k)) & 0xFF; 
+}
+
+/*
+    Hash to curve by try-and-increment: the index-th generator of domain is the first point
+    (x, y) with x = SHA256(len(domain) || domain || index || counter) for counter = 0, 1, ... and y even.
+    Every candidate succeeds with probability about 1/2, no one knows the DLOG between two generators,
+    and the generators depend only on (curve, domain, index), so they are reproducible and can be derived in parallel.
+*/
+void Hash_to_Curve(EC_POINT *&result, string domain, uint64_t index, BN_CTX *ctx)
+{
+    string message = Hash_to_Curve_message(domain, index); 
+
+    unsigned char buffer[POINT_LEN] = {0}; 
+    buffer[0] = POINT_CONVERSION_COMPRESSED; // 0x02: the point with even y
+    for(uint32_t counter = 0; ; counter++)
+    {
+        Hash_to_Curve_set_counter(message, counter); 
+        SHA256(reinterpret_cast<const unsigned char *>(message.data()), message.size(), buffer+1); 
+        // x must be a field element with x^3 + ax + b a square
+        if(EC_POINT_oct2point(group, result, buffer, POINT_LEN, ctx) == 1
+           && EC_POINT_is_at_infinity(group, result) == 0) break; 
+    }
+}
+
+/* 
+    true iff A is the index-th generator of domain, without square roots: the x of A must be the hash of 
+    the first counter whose hash x' has x'^3 + ax + b a square (the earlier ones have a Jacobi symbol of -1), 
+    and the y of A must be even 
+*/
+bool Hash_to_Curve_check(const EC_POINT *A, string domain, uint64_t index, BN_CTX *ctx)
+{
+    if(EC_POINT_is_at_infinity(group, A) == 1) return false; 
+    BN_CTX_start(ctx); 
+    BIGNUM *p = BN_CTX_get(ctx), *a = BN_CTX_get(ctx), *b = BN_CTX_get(ctx); 
+    BIGNUM *x = BN_CTX_get(ctx), *y = BN_CTX_get(ctx), *candidate = BN_CTX_get(ctx), *rhs = BN_CTX_get(ctx); 
+    bool VALID = (rhs != NULL && EC_GROUP_get_curve(group, p, a, b, ctx) == 1 
+                  && EC_POINT_get_affine_coordinates(group, A, x, y, ctx) == 1 && BN_is_odd(y) == 0); 
+
+    string message = Hash_to_Curve_message(domain, index); 
+    unsigned char hash_output[HASH_OUTPUT_LEN]; 
+    for(uint32_t counter = 0; VALID; counter++)
+    {
+        Hash_to_Curve_set_counter(message, counter); 
+        SHA256(reinterpret_cast<const unsigned char *>(message.data()), message.size(), hash_output); 
+        BN_bin2bn(hash_output, HASH_OUTPUT_LEN, candidate); 
+        if(BN_cmp(candidate, x) == 0) break; 
+        if(BN_cmp(candidate, p) >= 0) continue; // not a field element, Hash_to_Curve skips it as well
+        // rhs = x'^3 + ax' + b 
+        BN_mod_sqr(rhs, candidate, p, ctx); 
+        BN_mod_add(rhs, rhs, a, p, ctx); 
+        BN_mod_mul(rhs, rhs, candidate, p, ctx); 
+        BN_mod_add(rhs, rhs, b, p, ctx); 
+        if(BN_kronecker(rhs, p, ctx) != -1) VALID = false; // an earlier counter would have been taken 
+    }
+    BN_CTX_end(ctx); 
+    return VALID; 
+}
+
+/* parallel task: the generators start_index + k for k = t, t + THREAD_NUM, ... */
+void Hash_to_Curve_task(vector<EC_POINT *> &vec_A, string &domain, uint64_t start_index,
+                        size_t t, size_t THREAD_NUM)
+{
+    BN_CTX *ctx = BN_CTX_new(); 
+    for(auto k = t; k < vec_A.size(); k += THREAD_NUM){
+        Hash_to_Curve(vec_A[k], domain, start_index + k, ctx); 
+    }
+    BN_CTX_free(ctx); 
+}
+
+/* vec_A[k] = the (start_index + k)-th generator of domain, derived by THREAD_NUM threads */
+void Hash_to_Curve_vec(vector<EC_POINT *> &vec_A, string domain, uint64_t start_index = 0,
+                       size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if(THREAD_NUM == 0) THREAD_NUM = 1; 
+    THREAD_NUM = min(THREAD_NUM, max<size_t>(vec_A.size(), 1)); 
+
+    vector<thread> hash_task; 
+    for(auto t = 0; t < THREAD_NUM; t++){
+        hash_task.push_back(std::thread(Hash_to_Curve_task, std::ref(vec_A), std::ref(domain),
+                                        start_index, t, THREAD_NUM)); 
+    }
+    for(auto t = 0; t < THREAD_NUM; t++){
+        hash_task[t].join(); 
+    }
+}
+
+/* parallel task: check the generators start_index + k for k = t, t + THREAD_NUM, ... until one fails */
+void Hash_to_Curve_check_task(const vector<EC_POINT *> &vec_A, string &domain, uint64_t start_index,
+                              size_t t, size_t THREAD_NUM, atomic<bool> &VALID)
+{
+    BN_CTX *ctx = BN_CTX_new(); 
+    for(auto k = t; k < vec_A.size() && VALID; k += THREAD_NUM){
+        if(Hash_to_Curve_check(vec_A[k], domain, start_index + k, ctx) == false) VALID = false; 
+    }
+    BN_CTX_free(ctx); 
+}
+
+/* true iff vec_A[k] is the (start_index + k)-th generator of domain for every k, checked by THREAD_NUM threads */
+bool Hash_to_Curve_vec_check(const vector<EC_POINT *> &vec_A, string domain, uint64_t start_index = 0,
+                             size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if(THREAD_NUM == 0) THREAD_NUM = 1; 
+    THREAD_NUM = min(THREAD_NUM, max<size_t>(vec_A.size(), 1)); 
+
+    atomic<bool> VALID(true); 
+    vector<thread> check_task; 
+    for(auto t = 0; t < THREAD_NUM; t++){
+        check_task.push_back(std::thread(Hash_to_Curve_check_task, std::cref(vec_A), std::ref(domain),
+                                         start_index, t, THREAD_NUM, std::ref(VALID))); 
+    }
+    for(auto t = 0; t < THREAD_NUM; t++){
+        check_task[t].join(); 
+    }
+    return VALID; 
+}
+
 #endif
 
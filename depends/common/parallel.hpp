@@ -0,0 +1,52 @@
+/****************************************************************************
+this hpp implements parallel loops over index ranges
+*****************************************************************************
+* @author     This file is part of PGC, developed by Yu Chen
+* @paper      https://eprint.iacr.org/2019/319
+* @copyright  MIT license (see LICENSE file)
+*****************************************************************************/
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+#include "global.hpp"
+#include <functional>
+
+/*
+    Parallel_For cuts [0, n) into at most THREAD_NUM contiguous ranges and runs task(t, start, end, ctx)
+    on the t-th range in its own thread. The global bn_ctx is not thread-safe, so every thread gets its own
+    BN_CTX. t lets the caller keep per-thread partial results (e.g. partial sums) in a vector of THREAD_NUM entries.
+*/
+
+const size_t PARALLEL_MIN_CHUNK = 32; // ranges shorter than this do not pay for starting a thread
+
+typedef function<void(size_t t, size_t start, size_t end, BN_CTX *ctx)> Parallel_Task;
+
+void Parallel_For_task(Parallel_Task &task, size_t t, size_t start, size_t end)
+{
+    BN_CTX *ctx = BN_CTX_new();
+    task(t, start, end, ctx);
+    BN_CTX_free(ctx);
+}
+
+void Parallel_For(size_t n, Parallel_Task task, size_t THREAD_NUM = thread::hardware_concurrency())
+{
+    if(n == 0) return;
+    if(THREAD_NUM == 0) THREAD_NUM = 1;
+    THREAD_NUM = min(THREAD_NUM, max<size_t>(n/PARALLEL_MIN_CHUNK, 1));
+    if(THREAD_NUM == 1){
+        Parallel_For_task(task, 0, 0, n);
+        return;
+    }
+
+    size_t chunk = (n + THREAD_NUM - 1)/THREAD_NUM;
+    vector<thread> parallel_task;
+    for(auto t = 0; t < THREAD_NUM; t++){
+        size_t start = min(n, t*chunk), end = min(n, start + chunk);
+        parallel_task.push_back(std::thread(Parallel_For_task, std::ref(task), t, start, end));
+    }
+    for(auto t = 0; t < THREAD_NUM; t++){
+        parallel_task[t].join();
+    }
+}
+
+#endif
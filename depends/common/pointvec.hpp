@@ -0,0 +1,433 @@
+/****************************************************************************
+this hpp implements contiguous vectors of affine EC points and their arithmetic
+*****************************************************************************
+* @author     This file is part of PGC, developed by Yu Chen
+* @paper      https://eprint.iacr.org/2019/319
+* @copyright  MIT license (see LICENSE file)
+*****************************************************************************/
+#ifndef __POINTVEC__
+#define __POINTVEC__
+
+#include "global.hpp"
+#include "scalar.hpp"
+
+/*
+    A PointVec stores EC points of y^2 = x^3 + ax + b over F_p as affine coordinates in Montgomery form mod p,
+    contiguously in one allocation: 64 bytes per point, where an EC_POINT is a heap object with three BIGNUMs.
+    A slice (pointer, size) of a PointVec is a view, e.g. the left and right halves of the generators.
+    The arithmetic uses Jacobian points (X, Y, Z) = (X/Z^2, Y/Z^3), Z = 0 for the point at infinity, and the
+    formulas dbl-2007-bl, madd-2007-bl and add-2007-bl of the Explicit-Formulas Database. A mixed addition takes
+    an affine point, and a batch of Jacobian points returns to affine with one field inversion (Montgomery's trick).
+    In a PointVec the point at infinity is (0, 0), which is not on the curve since b != 0.
+    Points convert to and from EC_POINT only at the API edges.
+*/
+
+struct Affine_Point
+{
+    Scalar x;
+    Scalar y;
+};
+
+struct Jacobian_Point
+{
+    Scalar X;
+    Scalar Y;
+    Scalar Z;
+};
+
+typedef vector<Affine_Point> PointVec;
+
+/* a view of size consecutive points */
+struct PointVec_Slice
+{
+    const Affine_Point *data;
+    size_t size;
+};
+
+/* the constants of the curve of group */
+struct Curve_Constants
+{
+    BIGNUM *p;
+    Scalar_Field F;   // Montgomery arithmetic mod p
+    Scalar a;
+    Scalar b;
+    bool A_IS_ZERO;   // e.g. secp256k1: the doubling skips a*Z^4
+};
+
+Curve_Constants Curve_Constants_compute()
+{
+    Curve_Constants C;
+    C.p = BN_new(); // kept for the lifetime of the program, F refers to it
+    BIGNUM *a = BN_new();
+    BIGNUM *b = BN_new();
+    BN_CTX *ctx = BN_CTX_new();
+    EC_GROUP_get_curve(group, C.p, a, b, ctx);
+    if(BN_is_zero(b))
+    {
+        cout << "PointVec needs a curve with b != 0" << endl;
+        exit(EXIT_FAILURE);
+    }
+    C.F = Scalar_Field_compute(C.p);
+    Scalar_from_BN_mod(C.a, a, C.F, ctx);
+    Scalar_from_BN_mod(C.b, b, C.F, ctx);
+    C.A_IS_ZERO = BN_is_zero(a);
+    BN_free(a);
+    BN_free(b);
+    BN_CTX_free(ctx);
+    return C;
+}
+
+/* the constants of the current curve, computed once on first use (after global_initialize) */
+inline const Curve_Constants &Curve_constants()
+{
+    static const Curve_Constants C = Curve_Constants_compute();
+    return C;
+}
+
+/* shorthands of the arithmetic mod p */
+inline void Fp_add(Scalar &r, const Scalar &a, const Scalar &b, const Scalar_Field &F) { Scalar_add_mod(r, a, b, F); }
+inline void Fp_sub(Scalar &r, const Scalar &a, const Scalar &b, const Scalar_Field &F) { Scalar_sub_mod(r, a, b, F); }
+inline void Fp_mul(Scalar &r, const Scalar &a, const Scalar &b, const Scalar_Field &F) { Scalar_mul_mod(r, a, b, F); }
+inline void Fp_sqr(Scalar &r, const Scalar &a, const Scalar_Field &F) { Scalar_mul_mod(r, a, a, F); }
+
+inline bool Affine_is_infinity(const Affine_Point &P)
+{
+    return Scalar_is_zero(P.x) && Scalar_is_zero(P.y);
+}
+
+inline void Affine_set_infinity(Affine_Point &P)
+{
+    Scalar_zero(P.x);
+    Scalar_zero(P.y);
+}
+
+/* R = -P, R may be P */
+inline void Affine_negate(Affine_Point &R, const Affine_Point &P)
+{
+    R.x = P.x;
+    if(Affine_is_infinity(P)){
+        Scalar_zero(R.y);
+        return;
+    }
+    Scalar zero;
+    Scalar_zero(zero);
+    Fp_sub(R.y, zero, P.y, Curve_constants().F);
+}
+
+inline bool Jacobian_is_infinity(const Jacobian_Point &P)
+{
+    return Scalar_is_zero(P.Z);
+}
+
+inline void Jacobian_set_infinity(Jacobian_Point &P)
+{
+    P.X = Curve_constants().F.one;
+    P.Y = Curve_constants().F.one;
+    Scalar_zero(P.Z);
+}
+
+inline void Jacobian_from_affine(Jacobian_Point &R, const Affine_Point &P)
+{
+    if(Affine_is_infinity(P)){
+        Jacobian_set_infinity(R);
+        return;
+    }
+    R.X = P.x;
+    R.Y = P.y;
+    R.Z = Curve_constants().F.one;
+}
+
+/* R = 2P (dbl-2007-bl), R may be P */
+inline void Jacobian_double(Jacobian_Point &R, const Jacobian_Point &P)
+{
+    const Curve_Constants &C = Curve_constants();
+    const Scalar_Field &F = C.F;
+    if(Jacobian_is_infinity(P)){
+        R = P;
+        return;
+    }
+    Scalar XX, YY, YYYY, ZZ, S, M, T, temp;
+    Fp_sqr(XX, P.X, F);
+    Fp_sqr(YY, P.Y, F);
+    Fp_sqr(YYYY, YY, F);
+    Fp_sqr(ZZ, P.Z, F);
+    // S = 2((X + YY)^2 - XX - YYYY)
+    Fp_add(S, P.X, YY, F);
+    Fp_sqr(S, S, F);
+    Fp_sub(S, S, XX, F);
+    Fp_sub(S, S, YYYY, F);
+    Fp_add(S, S, S, F);
+    // M = 3XX + a ZZ^2
+    Fp_add(M, XX, XX, F);
+    Fp_add(M, M, XX, F);
+    if(C.A_IS_ZERO == false){
+        Fp_sqr(temp, ZZ, F);
+        Fp_mul(temp, temp, C.a, F);
+        Fp_add(M, M, temp, F);
+    }
+    // Z3 = (Y + Z)^2 - YY - ZZ, computed before Y and Z are overwritten
+    Fp_add(R.Z, P.Y, P.Z, F);
+    Fp_sqr(R.Z, R.Z, F);
+    Fp_sub(R.Z, R.Z, YY, F);
+    Fp_sub(R.Z, R.Z, ZZ, F);
+    // X3 = T = M^2 - 2S, Y3 = M(S - T) - 8 YYYY
+    Fp_sqr(T, M, F);
+    Fp_sub(T, T, S, F);
+    Fp_sub(T, T, S, F);
+    R.X = T;
+    Fp_sub(temp, S, T, F);
+    Fp_mul(R.Y, M, temp, F);
+    Fp_add(YYYY, YYYY, YYYY, F);
+    Fp_add(YYYY, YYYY, YYYY, F);
+    Fp_add(YYYY, YYYY, YYYY, F);
+    Fp_sub(R.Y, R.Y, YYYY, F);
+}
+
+/* R = P + Q for an affine Q (madd-2007-bl), R may be P */
+inline void Jacobian_add_affine(Jacobian_Point &R, const Jacobian_Point &P, const Affine_Point &Q)
+{
+    const Scalar_Field &F = Curve_constants().F;
+    if(Affine_is_infinity(Q)){
+        R = P;
+        return;
+    }
+    if(Jacobian_is_infinity(P)){
+        Jacobian_from_affine(R, Q);
+        return;
+    }
+    Scalar Z1Z1, U2, S2, H, HH, I, J, r, V, temp;
+    Fp_sqr(Z1Z1, P.Z, F);
+    Fp_mul(U2, Q.x, Z1Z1, F);
+    Fp_mul(S2, Q.y, P.Z, F);
+    Fp_mul(S2, S2, Z1Z1, F);
+    Fp_sub(H, U2, P.X, F);
+    Fp_sub(r, S2, P.Y, F);
+    if(Scalar_is_zero(H)){
+        if(Scalar_is_zero(r)) Jacobian_double(R, P); // P = Q
+        else Jacobian_set_infinity(R);               // P = -Q
+        return;
+    }
+    Fp_sqr(HH, H, F);
+    Fp_add(I, HH, HH, F);
+    Fp_add(I, I, I, F);
+    Fp_mul(J, H, I, F);
+    Fp_add(r, r, r, F);
+    Fp_mul(V, P.X, I, F);
+    // Z3 = (Z1 + H)^2 - Z1Z1 - HH
+    Fp_add(R.Z, P.Z, H, F);
+    Fp_sqr(R.Z, R.Z, F);
+    Fp_sub(R.Z, R.Z, Z1Z1, F);
+    Fp_sub(R.Z, R.Z, HH, F);
+    // Y3 = r(V - X3) - 2 Y1 J, with Y1 read before it is overwritten
+    Fp_mul(temp, P.Y, J, F);
+    Fp_add(temp, temp, temp, F);
+    // X3 = r^2 - J - 2V
+    Fp_sqr(R.X, r, F);
+    Fp_sub(R.X, R.X, J, F);
+    Fp_sub(R.X, R.X, V, F);
+    Fp_sub(R.X, R.X, V, F);
+    Fp_sub(V, V, R.X, F);
+    Fp_mul(R.Y, r, V, F);
+    Fp_sub(R.Y, R.Y, temp, F);
+}
+
+/* R = P + Q (add-2007-bl), R may be P or Q */
+inline void Jacobian_add(Jacobian_Point &R, const Jacobian_Point &P, const Jacobian_Point &Q)
+{
+    const Scalar_Field &F = Curve_constants().F;
+    if(Jacobian_is_infinity(Q)){
+        R = P;
+        return;
+    }
+    if(Jacobian_is_infinity(P)){
+        R = Q;
+        return;
+    }
+    Scalar Z1Z1, Z2Z2, U1, U2, S1, S2, H, I, J, r, V, temp;
+    Fp_sqr(Z1Z1, P.Z, F);
+    Fp_sqr(Z2Z2, Q.Z, F);
+    Fp_mul(U1, P.X, Z2Z2, F);
+    Fp_mul(U2, Q.X, Z1Z1, F);
+    Fp_mul(S1, P.Y, Q.Z, F);
+    Fp_mul(S1, S1, Z2Z2, F);
+    Fp_mul(S2, Q.Y, P.Z, F);
+    Fp_mul(S2, S2, Z1Z1, F);
+    Fp_sub(H, U2, U1, F);
+    Fp_sub(r, S2, S1, F);
+    if(Scalar_is_zero(H)){
+        if(Scalar_is_zero(r)) Jacobian_double(R, P);
+        else Jacobian_set_infinity(R);
+        return;
+    }
+    Fp_add(I, H, H, F);
+    Fp_sqr(I, I, F);
+    Fp_mul(J, H, I, F);
+    Fp_add(r, r, r, F);
+    Fp_mul(V, U1, I, F);
+    // Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) H
+    Fp_add(temp, P.Z, Q.Z, F);
+    Fp_sqr(temp, temp, F);
+    Fp_sub(temp, temp, Z1Z1, F);
+    Fp_sub(temp, temp, Z2Z2, F);
+    Fp_mul(R.Z, temp, H, F);
+    // X3 = r^2 - J - 2V, Y3 = r(V - X3) - 2 S1 J
+    Fp_sqr(R.X, r, F);
+    Fp_sub(R.X, R.X, J, F);
+    Fp_sub(R.X, R.X, V, F);
+    Fp_sub(R.X, R.X, V, F);
+    Fp_sub(V, V, R.X, F);
+    Fp_mul(R.Y, r, V, F);
+    Fp_mul(temp, S1, J, F);
+    Fp_add(temp, temp, temp, F);
+    Fp_sub(R.Y, R.Y, temp, F);
+}
+
+/* the 4-bit digit k (from the least significant) of a scalar stored in BN_LEN big-endian bytes */
+inline size_t POINTVEC_nibble(const unsigned char *scalar, size_t k)
+{
+    return (scalar[BN_LEN - 1 - k/2] >> (4*(k%2))) & 0xF;
+}
+
+/* R = a*P + b*Q with 4-bit fixed windows shared by both scalars (Straus), the scalars in BN_LEN big-endian bytes */
+void Jacobian_mul2(Jacobian_Point &R, const Affine_Point &P, const unsigned char *a,
+                   const Affine_Point &Q, const unsigned char *b)
+{
+    Jacobian_Point table_P[16], table_Q[16]; // k*P, k*Q for k < 16
+    Jacobian_set_infinity(table_P[0]);
+    Jacobian_set_infinity(table_Q[0]);
+    for(auto k = 1; k < 16; k++){
+        Jacobian_add_affine(table_P[k], table_P[k-1], P);
+        Jacobian_add_affine(table_Q[k], table_Q[k-1], Q);
+    }
+    Jacobian_set_infinity(R);
+    for(int k = 2*BN_LEN - 1; k >= 0; k--){
+        for(auto d = 0; d < 4; d++) Jacobian_double(R, R);
+        Jacobian_add(R, R, table_P[POINTVEC_nibble(a, k)]);
+        Jacobian_add(R, R, table_Q[POINTVEC_nibble(b, k)]);
+    }
+}
+
+/* R = a*P, the scalar in BN_LEN big-endian bytes */
+void Jacobian_mul(Jacobian_Point &R, const Affine_Point &P, const unsigned char *a)
+{
+    Jacobian_Point table_P[16];
+    Jacobian_set_infinity(table_P[0]);
+    for(auto k = 1; k < 16; k++) Jacobian_add_affine(table_P[k], table_P[k-1], P);
+    Jacobian_set_infinity(R);
+    for(int k = 2*BN_LEN - 1; k >= 0; k--){
+        for(auto d = 0; d < 4; d++) Jacobian_double(R, R);
+        Jacobian_add(R, R, table_P[POINTVEC_nibble(a, k)]);
+    }
+}
+
+/* vec_P[i] = vec_J[i] in affine coordinates with one field inversion (Montgomery's trick) */
+void Jacobian_vec_normalize(Affine_Point *vec_P, const Jacobian_Point *vec_J, size_t n)
+{
+    const Scalar_Field &F = Curve_constants().F;
+    vector<Scalar> vec_prefix(n); // the products of the nonzero Z's up to i
+    Scalar product = F.one;
+    for(auto i = 0; i < n; i++){
+        if(Jacobian_is_infinity(vec_J[i]) == false) Fp_mul(product, product, vec_J[i].Z, F);
+        vec_prefix[i] = product;
+    }
+    Scalar inverse, Z_inverse, Z_inverse_square;
+    Scalar_inverse_mod(inverse, product, F);
+    for(size_t i = n; i-- > 0; ){
+        if(Jacobian_is_infinity(vec_J[i])){
+            Affine_set_infinity(vec_P[i]);
+            continue;
+        }
+        // Z_i^{-1} = (Z_0...Z_i)^{-1} * (Z_0...Z_{i-1})
+        if(i > 0) Fp_mul(Z_inverse, inverse, vec_prefix[i-1], F);
+        else Z_inverse = inverse;
+        Fp_mul(inverse, inverse, vec_J[i].Z, F);
+        Fp_sqr(Z_inverse_square, Z_inverse, F);
+        Fp_mul(vec_P[i].x, vec_J[i].X, Z_inverse_square, F);
+        Fp_mul(Z_inverse_square, Z_inverse_square, Z_inverse, F);
+        Fp_mul(vec_P[i].y, vec_J[i].Y, Z_inverse_square, F);
+    }
+}
+
+/* the EC_POINT A as an affine point, A must be affine already or it costs an inversion */
+void Affine_from_ECP(Affine_Point &P, const EC_POINT *A, BIGNUM *x, BIGNUM *y, BN_CTX *ctx)
+{
+    if(EC_POINT_is_at_infinity(group, A)){
+        Affine_set_infinity(P);
+        return;
+    }
+    const Scalar_Field &F = Curve_constants().F;
+    EC_POINT_get_affine_coordinates(group, A, x, y, ctx);
+    Scalar_from_BN_mod(P.x, x, F, ctx);
+    Scalar_from_BN_mod(P.y, y, F, ctx);
+}
+
+void Affine_to_ECP(EC_POINT *A, const Affine_Point &P, BN_CTX *ctx)
+{
+    if(Affine_is_infinity(P)){
+        EC_POINT_set_to_infinity(group, A);
+        return;
+    }
+    const Scalar_Field &F = Curve_constants().F;
+    BIGNUM *x = BN_new();
+    BIGNUM *y = BN_new();
+    Scalar_to_BN_mod(x, P.x, F);
+    Scalar_to_BN_mod(y, P.y, F);
+    EC_POINT_set_affine_coordinates(group, A, x, y, ctx);
+    BN_free(x);
+    BN_free(y);
+}
+
+void Jacobian_to_ECP(EC_POINT *A, const Jacobian_Point &P, BN_CTX *ctx)
+{
+    Affine_Point Q;
+    Jacobian_vec_normalize(&Q, &P, 1);
+    Affine_to_ECP(A, Q, ctx);
+}
+
+/*
+    bulk conversion from OpenSSL points: their Jacobian coordinates are read and normalized with one inversion
+    vec_A is only read, so several threads may convert the same points (e.g. the public parameters) at once
+*/
+void PointVec_from_ECP(PointVec &vec_P, const vector<EC_POINT *> &vec_A, BN_CTX *ctx)
+{
+    const Scalar_Field &F = Curve_constants().F;
+    vector<Jacobian_Point> vec_J(vec_A.size());
+    BIGNUM *X = BN_new();
+    BIGNUM *Y = BN_new();
+    BIGNUM *Z = BN_new();
+    for(auto i = 0; i < vec_A.size(); i++)
+    {
+        if(EC_POINT_is_at_infinity(group, vec_A[i])){
+            Jacobian_set_infinity(vec_J[i]);
+            continue;
+        }
+        EC_POINT_get_Jprojective_coordinates_GFp(group, vec_A[i], X, Y, Z, ctx);
+        Scalar_from_BN_mod(vec_J[i].X, X, F, ctx);
+        Scalar_from_BN_mod(vec_J[i].Y, Y, F, ctx);
+        Scalar_from_BN_mod(vec_J[i].Z, Z, F, ctx);
+    }
+    BN_free(X);
+    BN_free(Y);
+    BN_free(Z);
+    vec_P.resize(vec_A.size());
+    Jacobian_vec_normalize(vec_P.data(), vec_J.data(), vec_J.size());
+}
+
+/* vec_A must have been allocated with vec_P.size() points */
+void PointVec_to_ECP(vector<EC_POINT *> &vec_A, const PointVec &vec_P, BN_CTX *ctx)
+{
+    if(vec_A.size() != vec_P.size())
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE);
+    }
+    for(auto i = 0; i < vec_P.size(); i++) Affine_to_ECP(vec_A[i], vec_P[i], ctx);
+}
+
+inline PointVec_Slice PointVec_slice(const PointVec &vec_P, size_t start, size_t size)
+{
+    PointVec_Slice slice = {vec_P.data() + start, size};
+    return slice;
+}
+
+#endif
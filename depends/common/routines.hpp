@@ -81,6 +81,44 @@ void BN_mod_negative(BIGNUM *&a)
     BN_mod_sub(a, BN_0, a, order, bn_ctx); // return a = -a mod order
 }
 
+/*
+    Montgomery's trick: vec_a_inverse[i] = vec_a[i]^{-1} mod order for all i with a single BN_mod_inverse 
+    and 3(n-1) multiplications, from the prefix products a[0]...a[i]. vec_a_inverse may be vec_a. 
+*/
+void BN_vec_batch_inverse(vector<BIGNUM *> &vec_a_inverse, const vector<BIGNUM *> &vec_a, BN_CTX *ctx = bn_ctx)
+{
+    size_t n = vec_a.size(); 
+    if(vec_a_inverse.size() != n){
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE); 
+    }
+    if(n == 0) return; 
+
+    vector<BIGNUM *> vec_prefix(n); // vec_prefix[i] = a[0]...a[i]
+    BN_vec_new(vec_prefix); 
+    BN_copy(vec_prefix[0], vec_a[0]); 
+    for(auto i = 1; i < n; i++){
+        BN_mod_mul(vec_prefix[i], vec_prefix[i-1], vec_a[i], order, ctx); 
+    }
+
+    BIGNUM *inverse = BN_new(); // (a[0]...a[i])^{-1} 
+    if(BN_mod_inverse(inverse, vec_prefix[n-1], order, ctx) == NULL){
+        cout << "BN_vec_batch_inverse: the vector has a zero entry" << endl;
+        exit(EXIT_FAILURE); 
+    }
+    BIGNUM *bn_temp = BN_new(); 
+    for(auto i = n - 1; i > 0; i--){
+        BN_mod_mul(bn_temp, inverse, vec_a[i], order, ctx);                // (a[0]...a[i-1])^{-1}
+        BN_mod_mul(vec_a_inverse[i], inverse, vec_prefix[i-1], order, ctx); // a[i]^{-1}
+        BN_copy(inverse, bn_temp); 
+    }
+    BN_copy(vec_a_inverse[0], inverse); 
+
+    BN_free(inverse); 
+    BN_free(bn_temp); 
+    BN_vec_free(vec_prefix); 
+}
+
 /* EC points operations */
 
 /* generate a random EC points */
@@ -194,27 +232,29 @@ int EC_POINT_sub_without_bnctx(EC_POINT *&r, EC_POINT *&a, EC_POINT *&b)
 }
 
 /* convert an EC point to string */
-string ECP_ep2string(EC_POINT *&A)
+string ECP_ep2string(const EC_POINT *A, BN_CTX *ctx = bn_ctx)
 {
     // unsigned char buffer[POINT_LEN] = "";
     // EC_POINT_point2oct(group, A, POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, bn_ctx);
     // string ecp_str(reinterpret_cast<char *>(buffer), POINT_LEN); 
     // return ecp_str; 
-    stringstream ss; 
-    ss << EC_POINT_point2hex(group, A, POINT_CONVERSION_COMPRESSED, bn_ctx);
-    return ss.str();  
+    char *hex = EC_POINT_point2hex(group, A, POINT_CONVERSION_COMPRESSED, ctx);
+    string ecp_str(hex); 
+    OPENSSL_free(hex); 
+    return ecp_str;  
 }
 
 /* convert a Big number to string */
-string BN_bn2string(BIGNUM *&a)
+string BN_bn2string(const BIGNUM *a)
 {
     // unsigned char buffer[BN_LEN] = "";
     // BN_bn2binpad(a, buffer, BN_LEN);
     // string bn_str(reinterpret_cast<char *>(buffer), BN_LEN); 
     // return bn_str; 
-    stringstream ss; 
-    ss << BN_bn2hex(a);
-    return ss.str();  
+    char *hex = BN_bn2hex(a);
+    string bn_str(hex); 
+    OPENSSL_free(hex); 
+    return bn_str;  
 }
 
 inline bool FILE_exist(const string& filename)
@@ -0,0 +1,400 @@
+/****************************************************************************
+this hpp implements fixed-width arithmetic mod the group order in Montgomery form
+*****************************************************************************
+* @author     This file is part of PGC, developed by Yu Chen
+* @paper      https://eprint.iacr.org/2019/319
+* @copyright  MIT license (see LICENSE file)
+*****************************************************************************/
+#ifndef __SCALAR__
+#define __SCALAR__
+
+#include "global.hpp"
+#include <openssl/rand.h>
+
+/*
+    A Scalar is an element of Z_order stored in 4 little-endian 64-bit limbs in Montgomery form a*R mod order
+    with R = 2^256, and a ScalarVec is a contiguous vector<Scalar>. Compared with vector<BIGNUM *>, there is no
+    heap object per element, no pointer chase and no generic division: a multiplication is one 4x4-limb CIOS
+    Montgomery product. Scalars convert to and from BIGNUM only at the API edges (Scalar_from_BN, Scalar_to_BN).
+    The kernels keep no state besides the constants of the order, so they are thread-safe.
+    The order must be odd and less than 2^256 (true for every prime-order curve of the supported sizes).
+    The *_mod variants take the constants of another odd modulus, e.g. the base field in pointvec.hpp.
+*/
+
+const size_t SCALAR_LIMB_NUM = 4;
+
+struct Scalar
+{
+    uint64_t limb[SCALAR_LIMB_NUM];
+};
+
+typedef vector<Scalar> ScalarVec;
+
+/* the constants of Montgomery arithmetic mod an odd modulus p < 2^256: the group order, or the base field (pointvec.hpp) */
+struct Scalar_Field
+{
+    const BIGNUM *modulus;        // p as a BIGNUM, for the conversions
+    uint64_t p[SCALAR_LIMB_NUM];  // p in limbs
+    uint64_t p_inverse;           // -p^{-1} mod 2^64
+    Scalar R2;                    // R^2 mod p: converts into Montgomery form
+    Scalar one;                   // R mod p: 1 in Montgomery form
+};
+
+/* load a little-endian byte string of BN_LEN bytes into limbs, independent of the host byte order */
+inline void Scalar_load_bytes(uint64_t *limb, const unsigned char *buffer)
+{
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++){
+        limb[k] = 0;
+        for(auto b = 0; b < 8; b++) limb[k] |= uint64_t(buffer[8*k + b]) << (8*b);
+    }
+}
+
+inline void Scalar_store_bytes(unsigned char *buffer, const uint64_t *limb)
+{
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++){
+        for(auto b = 0; b < 8; b++) buffer[8*k + b] = (limb[k] >> (8*b)) & 0xFF;
+    }
+}
+
+/* modulus must stay alive as long as the constants are used */
+Scalar_Field Scalar_Field_compute(const BIGNUM *modulus)
+{
+    Scalar_Field F;
+    if(BN_is_odd(modulus) == 0 || BN_num_bits(modulus) > 64*SCALAR_LIMB_NUM)
+    {
+        cout << "the modulus must be odd and at most 256 bits for Montgomery scalars" << endl;
+        exit(EXIT_FAILURE);
+    }
+    F.modulus = modulus;
+    unsigned char buffer[BN_LEN];
+    BN_bn2lebinpad(modulus, buffer, BN_LEN);
+    Scalar_load_bytes(F.p, buffer);
+
+    // p^{-1} mod 2^64 by Newton iteration: every step doubles the number of correct bits
+    uint64_t inverse = 1;
+    for(auto k = 0; k < 6; k++) inverse *= 2 - F.p[0]*inverse;
+    F.p_inverse = 0 - inverse;
+
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *bn_temp = BN_new();
+    BN_lshift(bn_temp, BN_1, 64*SCALAR_LIMB_NUM);
+    BN_mod(bn_temp, bn_temp, modulus, ctx);
+    BN_bn2lebinpad(bn_temp, buffer, BN_LEN);
+    Scalar_load_bytes(F.one.limb, buffer);
+    BN_lshift(bn_temp, BN_1, 2*64*SCALAR_LIMB_NUM);
+    BN_mod(bn_temp, bn_temp, modulus, ctx);
+    BN_bn2lebinpad(bn_temp, buffer, BN_LEN);
+    Scalar_load_bytes(F.R2.limb, buffer);
+    BN_free(bn_temp);
+    BN_CTX_free(ctx);
+    return F;
+}
+
+/* the constants of the current order, computed once on first use (after global_initialize) */
+inline const Scalar_Field &Scalar_field()
+{
+    static const Scalar_Field F = Scalar_Field_compute(order);
+    return F;
+}
+
+/* r = r - p if r >= p, where carry is the bit above the top limb */
+inline void Scalar_reduce_once(uint64_t *r, uint64_t carry, const uint64_t *p)
+{
+    uint64_t diff[SCALAR_LIMB_NUM];
+    uint64_t borrow = 0;
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++){
+        unsigned __int128 t = (unsigned __int128)r[k] - p[k] - borrow;
+        diff[k] = uint64_t(t);
+        borrow = uint64_t(t >> 64) & 1;
+    }
+    // keep the difference unless it borrowed out of a number without carry
+    if(carry != 0 || borrow == 0){
+        for(auto k = 0; k < SCALAR_LIMB_NUM; k++) r[k] = diff[k];
+    }
+}
+
+/* r = a + b mod p */
+inline void Scalar_add_mod(Scalar &r, const Scalar &a, const Scalar &b, const Scalar_Field &F)
+{
+    uint64_t carry = 0;
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++){
+        unsigned __int128 t = (unsigned __int128)a.limb[k] + b.limb[k] + carry;
+        r.limb[k] = uint64_t(t);
+        carry = uint64_t(t >> 64);
+    }
+    Scalar_reduce_once(r.limb, carry, F.p);
+}
+
+/* r = a - b mod p */
+inline void Scalar_sub_mod(Scalar &r, const Scalar &a, const Scalar &b, const Scalar_Field &F)
+{
+    uint64_t borrow = 0;
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++){
+        unsigned __int128 t = (unsigned __int128)a.limb[k] - b.limb[k] - borrow;
+        r.limb[k] = uint64_t(t);
+        borrow = uint64_t(t >> 64) & 1;
+    }
+    if(borrow != 0){ // add p back
+        uint64_t carry = 0;
+        for(auto k = 0; k < SCALAR_LIMB_NUM; k++){
+            unsigned __int128 t = (unsigned __int128)r.limb[k] + F.p[k] + carry;
+            r.limb[k] = uint64_t(t);
+            carry = uint64_t(t >> 64);
+        }
+    }
+}
+
+/* r = a*b*R^{-1} mod p: the Montgomery product (CIOS), so Montgomery forms multiply to a Montgomery form */
+inline void Scalar_mul_mod(Scalar &r, const Scalar &a, const Scalar &b, const Scalar_Field &F)
+{
+    uint64_t t[SCALAR_LIMB_NUM + 2] = {0};
+    for(auto i = 0; i < SCALAR_LIMB_NUM; i++)
+    {
+        // t = t + a*b[i]
+        uint64_t carry = 0;
+        for(auto j = 0; j < SCALAR_LIMB_NUM; j++){
+            unsigned __int128 s = (unsigned __int128)a.limb[j]*b.limb[i] + t[j] + carry;
+            t[j] = uint64_t(s);
+            carry = uint64_t(s >> 64);
+        }
+        unsigned __int128 s = (unsigned __int128)t[SCALAR_LIMB_NUM] + carry;
+        t[SCALAR_LIMB_NUM] = uint64_t(s);
+        t[SCALAR_LIMB_NUM + 1] = uint64_t(s >> 64);
+
+        // t = (t + m*p)/2^64 with m chosen to clear the lowest limb
+        uint64_t m = t[0]*F.p_inverse;
+        s = (unsigned __int128)m*F.p[0] + t[0];
+        carry = uint64_t(s >> 64);
+        for(auto j = 1; j < SCALAR_LIMB_NUM; j++){
+            s = (unsigned __int128)m*F.p[j] + t[j] + carry;
+            t[j-1] = uint64_t(s);
+            carry = uint64_t(s >> 64);
+        }
+        s = (unsigned __int128)t[SCALAR_LIMB_NUM] + carry;
+        t[SCALAR_LIMB_NUM - 1] = uint64_t(s);
+        t[SCALAR_LIMB_NUM] = t[SCALAR_LIMB_NUM + 1] + uint64_t(s >> 64);
+    }
+    Scalar_reduce_once(t, t[SCALAR_LIMB_NUM], F.p);
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++) r.limb[k] = t[k];
+}
+
+/* r = a^{-1} mod p = a^{p-2} for a prime p (a = 0 gives 0), left-to-right square and multiply */
+void Scalar_inverse_mod(Scalar &r, const Scalar &a, const Scalar_Field &F)
+{
+    uint64_t e[SCALAR_LIMB_NUM];
+    uint64_t borrow = 2;
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++){ // e = p - 2
+        unsigned __int128 t = (unsigned __int128)F.p[k] - borrow;
+        e[k] = uint64_t(t);
+        borrow = uint64_t(t >> 64) & 1;
+    }
+    Scalar result = F.one;
+    for(int bit = 64*SCALAR_LIMB_NUM - 1; bit >= 0; bit--){
+        Scalar_mul_mod(result, result, result, F);
+        if((e[bit/64] >> (bit%64)) & 1) Scalar_mul_mod(result, result, a, F);
+    }
+    r = result;
+}
+
+/* the arithmetic mod the group order */
+
+inline void Scalar_add(Scalar &r, const Scalar &a, const Scalar &b)
+{
+    Scalar_add_mod(r, a, b, Scalar_field());
+}
+
+inline void Scalar_sub(Scalar &r, const Scalar &a, const Scalar &b)
+{
+    Scalar_sub_mod(r, a, b, Scalar_field());
+}
+
+inline void Scalar_mul(Scalar &r, const Scalar &a, const Scalar &b)
+{
+    Scalar_mul_mod(r, a, b, Scalar_field());
+}
+
+inline void Scalar_zero(Scalar &r)
+{
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++) r.limb[k] = 0;
+}
+
+inline void Scalar_one(Scalar &r)
+{
+    r = Scalar_field().one;
+}
+
+inline bool Scalar_is_zero(const Scalar &a)
+{
+    uint64_t bits = 0;
+    for(auto k = 0; k < SCALAR_LIMB_NUM; k++) bits |= a.limb[k];
+    return bits == 0;
+}
+
+/* r = a^e */
+void Scalar_pow(Scalar &r, const Scalar &a, uint64_t e)
+{
+    Scalar result, base = a;
+    Scalar_one(result);
+    for(; e > 0; e >>= 1){
+        if(e & 1) Scalar_mul(result, result, base);
+        Scalar_mul(base, base, base);
+    }
+    r = result;
+}
+
+/* a uniformly random scalar: uniform limbs below the order are a uniform Montgomery form, so no conversion is needed */
+void Scalar_random(Scalar &a)
+{
+    const Scalar_Field &F = Scalar_field();
+    size_t top_bits = BN_num_bits(F.modulus) - 64*(SCALAR_LIMB_NUM - 1);
+    uint64_t top_mask = (top_bits == 64) ? ~uint64_t(0) : (uint64_t(1) << top_bits) - 1;
+    bool below_order = false;
+    while(below_order == false)
+    {
+        if(RAND_priv_bytes(reinterpret_cast<unsigned char *>(a.limb), sizeof(a.limb)) != 1)
+        {
+            cout << "Scalar_random: the random generator fails" << endl;
+            exit(EXIT_FAILURE);
+        }
+        a.limb[SCALAR_LIMB_NUM-1] &= top_mask;
+        for(int k = SCALAR_LIMB_NUM - 1; k >= 0; k--){ // rejection sampling: a < order
+            if(a.limb[k] != F.p[k]){
+                below_order = (a.limb[k] < F.p[k]);
+                break;
+            }
+        }
+    }
+}
+
+/* a = x mod p in Montgomery form, x may be negative or unreduced */
+void Scalar_from_BN_mod(Scalar &a, const BIGNUM *x, const Scalar_Field &F, BN_CTX *ctx)
+{
+    unsigned char buffer[BN_LEN];
+    if(BN_is_negative(x) || BN_cmp(x, F.modulus) >= 0)
+    {
+        BIGNUM *x_reduced = BN_new();
+        BN_nnmod(x_reduced, x, F.modulus, ctx);
+        BN_bn2lebinpad(x_reduced, buffer, BN_LEN);
+        BN_free(x_reduced);
+    }
+    else BN_bn2lebinpad(x, buffer, BN_LEN);
+    Scalar_load_bytes(a.limb, buffer);
+    Scalar_mul_mod(a, a, F.R2, F); // a*R^2*R^{-1} = a*R
+}
+
+/* x = a in [0, p) */
+void Scalar_to_BN_mod(BIGNUM *x, const Scalar &a, const Scalar_Field &F)
+{
+    Scalar plain, unit;
+    Scalar_zero(unit);
+    unit.limb[0] = 1;
+    Scalar_mul_mod(plain, a, unit, F); // a*R*R^{-1} = a
+    unsigned char buffer[BN_LEN];
+    Scalar_store_bytes(buffer, plain.limb);
+    BN_lebin2bn(buffer, BN_LEN, x);
+}
+
+/* the plain value of a as BN_LEN big-endian bytes, the scalar format of the multi-exponentiations */
+inline void Scalar_to_bytes_mod(unsigned char *buffer, const Scalar &a, const Scalar_Field &F)
+{
+    Scalar plain, unit;
+    Scalar_zero(unit);
+    unit.limb[0] = 1;
+    Scalar_mul_mod(plain, a, unit, F);
+    for(auto k = 0; k < BN_LEN; k++) buffer[BN_LEN - 1 - k] = (plain.limb[k/8] >> (8*(k%8))) & 0xFF;
+}
+
+inline void Scalar_to_bytes(unsigned char *buffer, const Scalar &a)
+{
+    Scalar_to_bytes_mod(buffer, a, Scalar_field());
+}
+
+inline void Scalar_from_BN(Scalar &a, const BIGNUM *x, BN_CTX *ctx)
+{
+    Scalar_from_BN_mod(a, x, Scalar_field(), ctx);
+}
+
+inline void Scalar_to_BN(BIGNUM *x, const Scalar &a)
+{
+    Scalar_to_BN_mod(x, a, Scalar_field());
+}
+
+/* vector kernels: plain loops over contiguous limbs, the result may alias an input */
+
+void ScalarVec_from_BN(ScalarVec &vec_a, vector<BIGNUM *> &vec_x, BN_CTX *ctx)
+{
+    vec_a.resize(vec_x.size());
+    for(auto i = 0; i < vec_x.size(); i++) Scalar_from_BN(vec_a[i], vec_x[i], ctx);
+}
+
+/* vec_x must have been allocated with vec_a.size() BIGNUMs */
+void ScalarVec_to_BN(vector<BIGNUM *> &vec_x, const ScalarVec &vec_a)
+{
+    if(vec_x.size() != vec_a.size())
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE);
+    }
+    for(auto i = 0; i < vec_a.size(); i++) Scalar_to_BN(vec_x[i], vec_a[i]);
+}
+
+inline void ScalarVec_add(ScalarVec &result, const ScalarVec &vec_a, const ScalarVec &vec_b)
+{
+    size_t n = min(vec_a.size(), vec_b.size());
+    result.resize(n);
+    for(auto i = 0; i < n; i++) Scalar_add(result[i], vec_a[i], vec_b[i]);
+}
+
+inline void ScalarVec_sub(ScalarVec &result, const ScalarVec &vec_a, const ScalarVec &vec_b)
+{
+    size_t n = min(vec_a.size(), vec_b.size());
+    result.resize(n);
+    for(auto i = 0; i < n; i++) Scalar_sub(result[i], vec_a[i], vec_b[i]);
+}
+
+/* result[i] = a[i]*b[i] */
+inline void ScalarVec_product(ScalarVec &result, const ScalarVec &vec_a, const ScalarVec &vec_b)
+{
+    size_t n = min(vec_a.size(), vec_b.size());
+    result.resize(n);
+    for(auto i = 0; i < n; i++) Scalar_mul(result[i], vec_a[i], vec_b[i]);
+}
+
+/* result[i] = c*a[i] */
+inline void ScalarVec_scalar(ScalarVec &result, const ScalarVec &vec_a, const Scalar &c)
+{
+    result.resize(vec_a.size());
+    for(auto i = 0; i < vec_a.size(); i++) Scalar_mul(result[i], vec_a[i], c);
+}
+
+/* result = <a, b> over the n entries starting at vec_a and vec_b */
+inline void ScalarVec_inner_product(Scalar &result, const Scalar *vec_a, const Scalar *vec_b, size_t n)
+{
+    Scalar product;
+    Scalar_zero(result);
+    for(auto i = 0; i < n; i++){
+        Scalar_mul(product, vec_a[i], vec_b[i]);
+        Scalar_add(result, result, product);
+    }
+}
+
+inline void ScalarVec_inner_product(Scalar &result, const ScalarVec &vec_a, const ScalarVec &vec_b)
+{
+    if(vec_a.size() != vec_b.size())
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE);
+    }
+    ScalarVec_inner_product(result, vec_a.data(), vec_b.data(), vec_a.size());
+}
+
+/* result = (1, a, a^2, ..., a^{n-1}) */
+inline void ScalarVec_gen_power(ScalarVec &result, size_t n, const Scalar &a)
+{
+    result.resize(n);
+    if(n == 0) return;
+    Scalar_one(result[0]);
+    for(auto i = 1; i < n; i++) Scalar_mul(result[i], result[i-1], a);
+}
+
+#endif
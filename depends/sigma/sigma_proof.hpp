@@ -255,7 +255,9 @@ void Sigma_Prove_Zero(Sigma_PP &pp,
     BIGNUM *x = BN_new(); 
     Hash_String_to_BN(transcript_str, x); // challenge x
     //BN_mod(x, x, order, bn_ctx);
+    #ifdef DEBUG
     BN_print(x, "x");
+    #endif
 
     // compute the response
     //BN_mod_sub(proof.beta1, x, proof.beta2,order, bn_ctx); // beta1 = x - beta2
@@ -328,7 +330,9 @@ void Sigma_Prove_One(Sigma_PP &pp,
     BIGNUM *x = BN_new(); 
     Hash_String_to_BN(transcript_str, x); // challenge x
     //BN_mod(x, x, order, bn_ctx);
+    #ifdef DEBUG
     BN_print(x, "x");
+    #endif
 
     // compute the response
     //BN_mod_sub(proof.beta1, x, proof.beta2,order, bn_ctx); // beta1 = x - beta2
@@ -360,11 +364,15 @@ bool Sigma_Verify(Sigma_PP &pp,
     BIGNUM *negone = BN_new();
     BN_copy(negone, BN_1);
     BN_set_negative(negone, 1);
+    #ifdef DEBUG
     BN_print(negone,"negone");
+    #endif
     BIGNUM *beta1_beta2 = BN_new();
     BN_add(beta1_beta2, proof.beta1, proof.beta2); //beta1 + beta2
 
+    #ifdef DEBUG
     BN_print(beta1_beta2, "beta1_beta2");
+    #endif
 
     EC_POINT *c1_h = EC_POINT_new(group); 
     const EC_POINT *vec_A[2]; 
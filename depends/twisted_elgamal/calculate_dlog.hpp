@@ -5,15 +5,25 @@ this hpp implements DLOG algorithm
 * @paper      https://eprint.iacr.org/2019/319
 * @copyright  MIT license (see LICENSE file)
 *****************************************************************************/
+#ifndef __DLOG__
+#define __DLOG__
 
 #include "../common/global.hpp"
+#include "../common/routines.hpp"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /* 
     Shanks algorithm for DLOG problem: given (g, h) find x \in [0, n = 2^RANGE_LEN) s.t. g^x = h 
     g^{j*giantstep_size + i} = g^x; giantstep_num = n/giantstep_size
 */
 
-unordered_map<string, unsigned long> point2index_map; // key-value hash table: key is EC POINT, value is its DLOG w.r.t. g
 
 /*
     Note that OpenSSL does not provide substract operation for EC points, 
@@ -66,21 +76,255 @@ void HASHMAP_serialize(EC_POINT *&g, string hashmap_file, size_t RANGE_LEN, size
     EC_POINT_free(ECP_babystep); 
 }
 
-/* rebuild hash map from hashmap file */
-void HASHMAP_deserialize(string hashmap_file, size_t RANGE_LEN, size_t TUNNING)
-{   
-    cout << "hash map already exists, begin to load and rebuild >>>" << endl; 
+/*
+    The baby steps are kept in a flat open-addressing hash table instead of an unordered_map. 
+    The table lives in one memory region laid out as [header | g^0, ..., g^{n-1} | slots], 
+    so a process can either hold a private copy or map the region from a named shared-memory segment: 
+    the first process publishes the segment, later processes attach to it read-only. 
+    A slot stores (tag << 32) | (index + 1), where the position and the tag are taken from the x-coordinate 
+    of the compressed point; a tag match is confirmed against the stored point. 
 
-    auto start_time = chrono::steady_clock::now(); // start to count the time
-    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); 
+    The table is loaded in blocks of HASHMAP_LOAD_LEN entries, and header.loaded_num publishes the prefix 
+    [0, loaded_num) that is already inserted. Slots are only ever filled, so a search that started on a prefix 
+    stays correct while later blocks are inserted: until the table is complete, the DLOG algorithms use 
+    the loaded prefix as the baby steps (degraded mode: more giant steps, same results). 
+*/
 
-    unsigned char* buffer = new unsigned char[giantstep_size*POINT_LEN]();  
-    if(buffer == NULL)
+const uint64_t HASHMAP_MAGIC = 0x50474353484E4B31;       // marks a complete table
+const uint64_t HASHMAP_MAGIC_INIT = 0x50474353484E4B30;  // marks a table whose header is set but which is still loading
+const uint64_t HASHMAP_HEADER_LEN = 4096;                 // the points start on a page boundary
+const uint64_t HASHMAP_LOAD_LEN = 1 << 16;                // number of entries published at once
+const uint64_t HASHMAP_ATTACH_TIMEOUT = 600;              // seconds to wait for a segment being published
+
+struct HASHMAP_Header
+{
+    std::atomic<uint64_t> magic;      // HASHMAP_MAGIC_INIT, then HASHMAP_MAGIC after the table is complete
+    uint64_t RANGE_LEN; 
+    uint64_t TUNNING; 
+    uint64_t entry_num;               // number of baby steps
+    uint64_t slot_num;                // a power of 2, at least 2*entry_num
+    std::atomic<uint64_t> loaded_num; // the entries [0, loaded_num) are in the table
+};
+
+struct HASHMAP_Table
+{
+    unsigned char *base;              // the memory region
+    size_t region_len; 
+    bool shared;                      // true: mapped from a shared-memory segment 
+    HASHMAP_Header *header; 
+    unsigned char *point;             // point + i*POINT_LEN: the compressed g^i
+    std::atomic<uint64_t> *slot; 
+    uint64_t slot_mask; 
+};
+
+HASHMAP_Table point2index_table = {NULL, 0, false, NULL, NULL, NULL, 0}; // key is EC POINT, value is its DLOG w.r.t. g
+
+std::mutex hashmap_load_mutex;             // HASHMAP_load signals every loaded block of this process on hashmap_load_cv
+std::condition_variable hashmap_load_cv; 
+
+/* the size of the memory region of a table with entry_num entries */
+size_t HASHMAP_region_len(uint64_t entry_num, uint64_t &slot_num)
+{
+    slot_num = 1; 
+    while(slot_num < 2*entry_num) slot_num <<= 1; 
+    uint64_t point_len = (entry_num*POINT_LEN + 7) & ~uint64_t(7); // keep the slots 8-byte aligned
+    return HASHMAP_HEADER_LEN + point_len + slot_num*sizeof(uint64_t); 
+}
+
+/* set the pointers of the table to the region at base (entry_num and slot_num are given by the caller) */
+void HASHMAP_bind(unsigned char *base, size_t region_len, bool shared, uint64_t entry_num, uint64_t slot_num)
+{
+    point2index_table.base = base; 
+    point2index_table.region_len = region_len; 
+    point2index_table.shared = shared; 
+    point2index_table.header = reinterpret_cast<HASHMAP_Header *>(base); 
+    point2index_table.point = base + HASHMAP_HEADER_LEN; 
+    uint64_t point_len = (entry_num*POINT_LEN + 7) & ~uint64_t(7); 
+    point2index_table.slot = reinterpret_cast<std::atomic<uint64_t> *>(base + HASHMAP_HEADER_LEN + point_len); 
+    point2index_table.slot_mask = slot_num - 1; 
+}
+
+/* set the header of a zeroed region and bind it */
+void HASHMAP_prepare(unsigned char *base, size_t region_len, bool shared, 
+                     size_t RANGE_LEN, size_t TUNNING, uint64_t entry_num, uint64_t slot_num)
+{
+    HASHMAP_Header *header = reinterpret_cast<HASHMAP_Header *>(base); 
+    header->RANGE_LEN = RANGE_LEN; 
+    header->TUNNING = TUNNING; 
+    header->entry_num = entry_num; 
+    header->slot_num = slot_num; 
+    header->loaded_num.store(0, std::memory_order_relaxed); 
+    header->magic.store(HASHMAP_MAGIC_INIT, std::memory_order_release); 
+    HASHMAP_bind(base, region_len, shared, entry_num, slot_num); 
+}
+
+/* release the table (not while it is being loaded): a shared segment is unmapped but stays published */
+void HASHMAP_free()
+{
+    if(point2index_table.base == NULL) return; 
+    if(point2index_table.shared) munmap(point2index_table.base, point2index_table.region_len); 
+    else delete[] point2index_table.base; 
+    point2index_table = {NULL, 0, false, NULL, NULL, NULL, 0}; 
+}
+
+/* remove the shared-memory segment: processes that have attached keep their mapping */
+void HASHMAP_unlink(string shm_name)
+{
+    shm_unlink(shm_name.c_str()); 
+}
+
+/* number of entries that can be searched now */
+inline uint64_t HASHMAP_loaded_num()
+{
+    if(point2index_table.header == NULL) return 0; 
+    return point2index_table.header->loaded_num.load(std::memory_order_acquire); 
+}
+
+inline bool HASHMAP_empty()
+{
+    return HASHMAP_loaded_num() == 0; 
+}
+
+/* the table is completely loaded */
+inline bool HASHMAP_ready()
+{
+    return point2index_table.header != NULL && 
+           point2index_table.header->magic.load(std::memory_order_acquire) == HASHMAP_MAGIC; 
+}
+
+/* a block has been loaded or the table is complete: wake up the threads in HASHMAP_wait_loaded */
+void HASHMAP_notify()
+{
+    { std::lock_guard<std::mutex> lock(hashmap_load_mutex); } // a waiter is either before its check or waiting
+    hashmap_load_cv.notify_all(); 
+}
+
+/* wait until the table is searchable, i.e. it is complete or has a loaded block: the loader must be this process */
+void HASHMAP_wait_loaded()
+{
+    std::unique_lock<std::mutex> lock(hashmap_load_mutex); 
+    hashmap_load_cv.wait(lock, []{ return HASHMAP_empty() == false || HASHMAP_ready() == true; }); 
+}
+
+/* wait at most timeout milliseconds for the table to be complete */
+bool HASHMAP_wait(uint64_t timeout)
+{
+    auto start_time = chrono::steady_clock::now(); 
+    while(HASHMAP_ready() == false)
     {
-        cout << "fail to create buffer" << endl; 
-        exit(EXIT_FAILURE); 
-    }   
-    // load hashmap_file to buffer
+        if(chrono::steady_clock::now() - start_time >= chrono::milliseconds(timeout)) return false; 
+        this_thread::sleep_for(chrono::milliseconds(1)); 
+    }
+    return true; 
+}
+
+/* 
+    the giant-step size and the number of giant steps for the current table: 
+    2^{RANGE_LEN/2 + TUNNING} baby steps once complete, the loaded prefix before; 
+    range_size is the range of the complete table, which the last giant step may pass on the prefix
+*/
+void HASHMAP_steps(size_t RANGE_LEN, size_t TUNNING, uint64_t &giantstep_size, uint64_t &loop_num, 
+                   uint64_t &range_size)
+{
+    giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); 
+    loop_num = pow(2, RANGE_LEN/2 - TUNNING); 
+    range_size = giantstep_size * loop_num; 
+    uint64_t loaded_num = HASHMAP_loaded_num(); 
+    if(loaded_num != 0 && loaded_num < giantstep_size)
+    {
+        giantstep_size = loaded_num; 
+        loop_num = (range_size + loaded_num - 1) / loaded_num; 
+    }
+}
+
+/* the bound of the baby steps at giant step j, so that x = i + j*giantstep_size < range_size */
+inline uint64_t HASHMAP_step_bound(uint64_t giantstep_size, uint64_t range_size, uint64_t j)
+{
+    return min(giantstep_size, range_size - j*giantstep_size); 
+}
+
+/* position and tag of a compressed point (the point at infinity is all zero) */
+inline void HASHMAP_key_hash(const unsigned char *key, uint64_t &position, uint64_t &tag)
+{
+    uint32_t tag32; 
+    memcpy(&position, key+1, sizeof(uint64_t)); 
+    memcpy(&tag32, key+1+sizeof(uint64_t), sizeof(uint32_t)); 
+    tag = tag32 ^ key[0]; // the parity byte tells P from -P
+}
+
+/* find the index i < index_bound s.t. key is the compressed g^i */
+inline bool HASHMAP_find(const unsigned char *key, uint64_t &index, uint64_t index_bound)
+{
+    uint64_t position, tag; 
+    HASHMAP_key_hash(key, position, tag); 
+    for(uint64_t k = position & point2index_table.slot_mask; ; k = (k+1) & point2index_table.slot_mask)
+    {
+        uint64_t s = point2index_table.slot[k].load(std::memory_order_relaxed); 
+        if(s == 0) return false; 
+        if((s >> 32) == tag && (s & 0xFFFFFFFF) <= index_bound)
+        {
+            index = (s & 0xFFFFFFFF) - 1; 
+            if(memcmp(point2index_table.point + index*POINT_LEN, key, POINT_LEN) == 0) return true; 
+        }
+    }
+}
+
+/*
+    With a table much larger than the cache almost every probe misses. A batched probe prefetches the first slot
+    of HASHMAP_PROBE_WINDOW keys before it resolves any of them, so that their cache misses overlap.
+*/
+const size_t HASHMAP_PROBE_WINDOW = 32; // keys whose slots are in flight at once
+
+/*
+    probe the keys[0, n) (n compressed points stored back to back): vec_found[k] = 1 and vec_index[k] = i
+    iff key k is the compressed g^i with i < index_bound; return the number of keys found
+*/
+size_t HASHMAP_probe_batch(const unsigned char *keys, size_t n, uint64_t *vec_index, int *vec_found,
+                           uint64_t index_bound)
+{
+    uint64_t position[HASHMAP_PROBE_WINDOW], tag[HASHMAP_PROBE_WINDOW]; 
+    size_t found_num = 0; 
+    for(size_t window_start = 0; window_start < n; window_start += HASHMAP_PROBE_WINDOW)
+    {
+        size_t window_len = min(HASHMAP_PROBE_WINDOW, n - window_start); 
+        for(auto k = 0; k < window_len; k++)
+        {
+            HASHMAP_key_hash(keys + (window_start+k)*POINT_LEN, position[k], tag[k]); 
+            position[k] &= point2index_table.slot_mask; 
+            __builtin_prefetch(point2index_table.slot + position[k]); 
+        }
+        for(auto k = 0; k < window_len; k++)
+        {
+            const unsigned char *key = keys + (window_start+k)*POINT_LEN; 
+            vec_found[window_start+k] = 0; 
+            for(uint64_t p = position[k]; ; p = (p+1) & point2index_table.slot_mask)
+            {
+                uint64_t s = point2index_table.slot[p].load(std::memory_order_relaxed); 
+                if(s == 0) break; 
+                if((s >> 32) == tag[k] && (s & 0xFFFFFFFF) <= index_bound)
+                {
+                    uint64_t index = (s & 0xFFFFFFFF) - 1; 
+                    if(memcmp(point2index_table.point + index*POINT_LEN, key, POINT_LEN) == 0)
+                    {
+                        vec_index[window_start+k] = index; 
+                        vec_found[window_start+k] = 1; 
+                        found_num++; 
+                        break; 
+                    }
+                }
+            }
+        }
+    }
+    return found_num; 
+}
+
+/* load the points from hashmap_file into the prepared table and insert them block by block */
+void HASHMAP_load(string hashmap_file)
+{
+    auto start_time = chrono::steady_clock::now(); // start to count the time
+    HASHMAP_Header *header = point2index_table.header; 
+    uint64_t entry_num = header->entry_num; 
+
     ifstream fin; 
     fin.open(hashmap_file, ios::binary); 
     if(!fin)
@@ -90,86 +334,289 @@ void HASHMAP_deserialize(string hashmap_file, size_t RANGE_LEN, size_t TUNNING)
     }
     fin.seekg(0, fin.end);
     size_t FILE_LEN = fin.tellg(); // get the size of hash table file
-    if (FILE_LEN != giantstep_size*POINT_LEN)
+    if (FILE_LEN < entry_num*POINT_LEN) // a larger file holds a larger table, whose prefix is used
     {
         cout << "buffer size does not match hashmap size" << endl; 
         exit(EXIT_FAILURE); 
     }
     fin.seekg(0);                  // reset the file pointer to the beginning of file
-    fin.read(reinterpret_cast<char*>(buffer), FILE_LEN); // read file from disk to RAM
-    fin.close(); 
 
-    // reconstruct hashmap from buffer 
-    string str; 
-
-    /* point_to_index_map[ECn_to_String(babystep)] = i */
-    for(auto i = 0; i < giantstep_size; i++)
+    // read a block from disk to RAM, insert g^i with linear probing, then publish the block
+    uint64_t position, tag; 
+    for(uint64_t block_start = 0; block_start < entry_num; block_start += HASHMAP_LOAD_LEN)
     {
-        str.assign(reinterpret_cast<char *>(buffer+(i*POINT_LEN)), POINT_LEN);  
-        point2index_map[str] = i; 
+        uint64_t block_end = min(block_start + HASHMAP_LOAD_LEN, entry_num); 
+        fin.read(reinterpret_cast<char*>(point2index_table.point + block_start*POINT_LEN), 
+                 (block_end - block_start)*POINT_LEN); 
+        for(uint64_t i = block_start; i < block_end; i++)
+        {
+            HASHMAP_key_hash(point2index_table.point + i*POINT_LEN, position, tag); 
+            uint64_t k = position & point2index_table.slot_mask; 
+            while(point2index_table.slot[k].load(std::memory_order_relaxed) != 0) k = (k+1) & point2index_table.slot_mask; 
+            point2index_table.slot[k].store((tag << 32) | (i+1), std::memory_order_relaxed); 
+        }
+        header->loaded_num.store(block_end, std::memory_order_release); 
+        HASHMAP_notify(); 
     }
+    fin.close(); 
 
-    delete[] buffer; 
+    header->magic.store(HASHMAP_MAGIC, std::memory_order_release); 
+    HASHMAP_notify(); 
+    if(point2index_table.shared){
+        mprotect(point2index_table.base, point2index_table.region_len, PROT_READ); // read-only for the publisher as well
+    }
     
     auto end_time = chrono::steady_clock::now(); // end to count the time
     auto running_time = end_time - start_time;
     cout << "hash map loading and rebuilding takes time = " 
     << chrono::duration <double, milli> (running_time).count() << " ms" << endl;
+}
+
+/* allocate an empty private table for 2^{RANGE_LEN/2 + TUNNING} entries */
+void HASHMAP_reserve(size_t RANGE_LEN, size_t TUNNING)
+{
+    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); 
+    if(giantstep_size >= (uint64_t(1) << 32))
+    {
+        cout << "the hash map supports at most 2^32 - 1 entries" << endl; 
+        exit(EXIT_FAILURE); 
+    }
+
+    HASHMAP_free(); 
+    uint64_t slot_num; 
+    size_t region_len = HASHMAP_region_len(giantstep_size, slot_num); 
+    unsigned char *base = new unsigned char[region_len](); 
+    HASHMAP_prepare(base, region_len, false, RANGE_LEN, TUNNING, giantstep_size, slot_num); 
+}
+
+/* rebuild hash map from hashmap file */
+void HASHMAP_deserialize(string hashmap_file, size_t RANGE_LEN, size_t TUNNING)
+{   
+    cout << "hash map already exists, begin to load and rebuild >>>" << endl; 
+    HASHMAP_reserve(RANGE_LEN, TUNNING); 
+    HASHMAP_load(hashmap_file); 
 } 
 
-/* compute x s.t. y g^x = h: finding = false indicates there is no such x in specified range */
-bool Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, size_t RANGE_LEN, size_t TUNNING)
+/* 
+    create the shared-memory segment shm_name for an empty table and bind it: 
+    return false if the segment exists already, the caller then loads the table with HASHMAP_load
+    hugepage = true asks for transparent huge pages (effective if shmem_enabled allows)
+*/
+bool HASHMAP_create(string shm_name, size_t RANGE_LEN, size_t TUNNING, bool hugepage = false)
 {
-    /* giantstep_size * loop_num = 2^RANGE_LEN */
+    int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644); 
+    if(fd < 0)
+    {
+        if(errno == EEXIST) return false; 
+        cout << shm_name << " open error" << endl; 
+        exit(EXIT_FAILURE); 
+    }
+
+    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); 
+    if(giantstep_size >= (uint64_t(1) << 32))
+    {
+        cout << "the hash map supports at most 2^32 - 1 entries" << endl; 
+        shm_unlink(shm_name.c_str()); 
+        exit(EXIT_FAILURE); 
+    }
+    uint64_t slot_num; 
+    size_t region_len = HASHMAP_region_len(giantstep_size, slot_num); 
+    if(ftruncate(fd, region_len) != 0)
+    {
+        cout << shm_name << " resize error" << endl; 
+        shm_unlink(shm_name.c_str()); 
+        exit(EXIT_FAILURE); 
+    }
+    unsigned char *base = (unsigned char *)mmap(NULL, region_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0); 
+    close(fd); 
+    if(base == MAP_FAILED)
+    {
+        cout << shm_name << " map error" << endl; 
+        shm_unlink(shm_name.c_str()); 
+        exit(EXIT_FAILURE); 
+    }
+#ifdef MADV_HUGEPAGE
+    if(hugepage) madvise(base, region_len, MADV_HUGEPAGE); 
+#endif
+
+    HASHMAP_free(); 
+    HASHMAP_prepare(base, region_len, true, RANGE_LEN, TUNNING, giantstep_size, slot_num); 
+    return true; 
+}
+
+/* 
+    attach to the hash map published in shm_name: return false if there is no such segment
+    the segment may still be loading: its loaded prefix is searchable right away 
+    a segment that is not even started is waited for up to timeout seconds
+*/
+bool HASHMAP_attach(EC_POINT *&g, string shm_name, size_t RANGE_LEN, size_t TUNNING, 
+                    uint64_t timeout = HASHMAP_ATTACH_TIMEOUT)
+{
+    int fd = shm_open(shm_name.c_str(), O_RDONLY, 0); 
+    if(fd < 0) return false; 
+
+    cout << "shared hash map exists, begin to attach >>>" << endl; 
+    auto start_time = chrono::steady_clock::now(); // start to count the time
     uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); 
-    uint64_t loop_num  = pow(2, RANGE_LEN/2 - TUNNING); 
+    uint64_t slot_num; 
+    size_t region_len = HASHMAP_region_len(giantstep_size, slot_num); 
+
+    // wait until the publisher has sized the segment, set the header and loaded g^0, g^1
+    struct stat st; 
+    unsigned char *base = NULL; 
+    while(true)
+    {
+        if(base == NULL && fstat(fd, &st) == 0 && st.st_size != 0)
+        {
+            if(st.st_size != region_len)
+            {
+                cout << "shared hash map size does not match hashmap size" << endl; 
+                exit(EXIT_FAILURE); 
+            }
+            base = (unsigned char *)mmap(NULL, region_len, PROT_READ, MAP_SHARED, fd, 0); 
+            if(base == MAP_FAILED)
+            {
+                cout << shm_name << " map error" << endl; 
+                exit(EXIT_FAILURE); 
+            }
+        }
+        if(base != NULL)
+        {
+            HASHMAP_Header *header = reinterpret_cast<HASHMAP_Header *>(base); 
+            uint64_t magic = header->magic.load(std::memory_order_acquire); 
+            if((magic == HASHMAP_MAGIC_INIT || magic == HASHMAP_MAGIC) && 
+               header->loaded_num.load(std::memory_order_acquire) >= min<uint64_t>(2, giantstep_size)) break; 
+        }
+        if(chrono::steady_clock::now() - start_time > chrono::seconds(timeout))
+        {
+            cout << shm_name << " is incomplete: remove it with HASHMAP_unlink and retry" << endl; 
+            exit(EXIT_FAILURE); 
+        }
+        this_thread::sleep_for(chrono::milliseconds(1)); 
+    }
+    close(fd); 
+
+    // check that the segment holds the same table
+    HASHMAP_Header *header = reinterpret_cast<HASHMAP_Header *>(base); 
+    unsigned char buffer[POINT_LEN] = {0}; 
+    EC_POINT_point2oct(group, g, POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, bn_ctx); 
+    if(header->RANGE_LEN != RANGE_LEN || header->TUNNING != TUNNING || header->entry_num != giantstep_size 
+       || giantstep_size < 2 || memcmp(base + HASHMAP_HEADER_LEN + POINT_LEN, buffer, POINT_LEN) != 0)
+    {
+        cout << "shared hash map does not match the parameters" << endl; 
+        exit(EXIT_FAILURE); 
+    }
+
+    HASHMAP_free(); 
+    HASHMAP_bind(base, region_len, true, giantstep_size, slot_num); 
+
+    auto end_time = chrono::steady_clock::now(); // end to count the time
+    auto running_time = end_time - start_time;
+    cout << "shared hash map attaching takes time = " 
+    << chrono::duration <double, milli> (running_time).count() << " ms" << endl;
+    return true; 
+}
+
+/* 
+    load hashmap_file into the shared-memory segment shm_name and publish it, 
+    if another process publishes the segment first, attach to it and wait until it is complete
+*/
+void HASHMAP_publish(EC_POINT *&g, string hashmap_file, string shm_name, 
+                     size_t RANGE_LEN, size_t TUNNING, bool hugepage = false)
+{
+    if(HASHMAP_create(shm_name, RANGE_LEN, TUNNING, hugepage))
+    {
+        cout << "shared hash map does not exist, begin to load and publish >>>" << endl; 
+        HASHMAP_load(hashmap_file); 
+        return; 
+    }
+    if(HASHMAP_attach(g, shm_name, RANGE_LEN, TUNNING) == false || 
+       HASHMAP_wait(HASHMAP_ATTACH_TIMEOUT*1000) == false)
+    {
+        cout << shm_name << " is incomplete: remove it with HASHMAP_unlink and retry" << endl; 
+        exit(EXIT_FAILURE); 
+    }
+}
+
+/*
+    Search order: with an expected value hint of x, the giant steps are visited in a spiral around 
+    center = hint/giantstep_size: center, center+1, center-1, center+2, ... until both ends of [0, loop_num) are reached. 
+    A good hint finds x after a few giant steps, a bad one costs no more than the plain upward scan (hint = 0). 
+*/
+
+/* the r-th element of the spiral order of [0, n) around center */
+inline uint64_t DLOG_spiral(uint64_t center, uint64_t r, uint64_t n)
+{
+    uint64_t below = center, above = n - 1 - center; 
+    uint64_t m = min(below, above); // both sides are visited alternately up to distance m
+    if(r <= 2*m) return (r % 2 == 1) ? center + (r+1)/2 : center - r/2; 
+    return (above > below) ? center + (r - m) : center - (r - m); 
+}
+
+/* the giant step the spiral search starts at */
+inline uint64_t DLOG_center(uint64_t hint, uint64_t giantstep_size, uint64_t loop_num)
+{
+    return min(hint / giantstep_size, loop_num - 1); 
+}
+
+/* 
+    compute x s.t. y g^x = h: finding = false indicates there is no such x in specified range 
+    the search starts at the expected value hint and spirals outward
+*/
+bool Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, size_t RANGE_LEN, size_t TUNNING, uint64_t hint = 0)
+{
+    // check if the hash map is empty
+    if(HASHMAP_empty() == true)
+    {
+        cout << "the hashmap is empty" << endl; 
+        exit (EXIT_FAILURE);
+    }
+
+    /* giantstep_size * loop_num = 2^RANGE_LEN */
+    uint64_t giantstep_size, loop_num, range_size; 
+    HASHMAP_steps(RANGE_LEN, TUNNING, giantstep_size, loop_num, range_size); 
+    uint64_t center = DLOG_center(hint, giantstep_size, loop_num); 
 
     /* compute the giantstep */
     EC_POINT* ECP_giantstep = EC_POINT_new(group); 
+    EC_POINT* ECP_giantstep_back = EC_POINT_new(group); 
     BIGNUM* BN_giantstep_size = BN_new(); 
     BN_set_word(BN_giantstep_size, giantstep_size);
-    EC_POINT_mul(group, ECP_giantstep, NULL, g, BN_giantstep_size, bn_ctx); // set giantstep = g^giantstep_size
+    EC_POINT_mul(group, ECP_giantstep_back, NULL, g, BN_giantstep_size, bn_ctx); // set giantstep_back = g^giantstep_size
+    EC_POINT_copy(ECP_giantstep, ECP_giantstep_back); 
     EC_POINT_invert(group, ECP_giantstep, bn_ctx);
 
     /* begin to search */
     uint64_t i, j; // define two indices used to record babystep and giantstep
-    EC_POINT* searchpoint = EC_POINT_new(group); 
-    EC_POINT_copy(searchpoint, h);  // set the searchpoint to h
+    EC_POINT* searchpoint_up = EC_POINT_new(group);   // h - j*giantstep_size for the next j >= center
+    EC_POINT* searchpoint_down = EC_POINT_new(group); // h - j*giantstep_size for the next j < center
+    BIGNUM* BN_center = BN_new(); 
+    BN_set_word(BN_center, center); 
+    EC_POINT_mul(group, searchpoint_up, NULL, ECP_giantstep, BN_center, bn_ctx); 
+    EC_POINT_add(group, searchpoint_up, searchpoint_up, h, bn_ctx);  // set the searchpoint to h - center*giantstep_size
+    EC_POINT_add(group, searchpoint_down, searchpoint_up, ECP_giantstep_back, bn_ctx); 
   
-    string ecp_str; 
     bool finding = false; // set the initial finding flag to be false
 
-    // check if the hash map is empty
-    if(point2index_map.empty() == true)
-    {
-        cout << "the hashmap is empty" << endl; 
-        exit (EXIT_FAILURE);
-    }
-
-    unsigned char *buffer = new unsigned char[loop_num*POINT_LEN](); 
-    if (buffer == NULL)
-    {
-        cout << "fail to create buffer" << endl; 
-        exit(EXIT_FAILURE); 
-    } 
+    unsigned char buffer[POINT_LEN]; 
     // giant-step and baby-step search
-    for(j = 0; j < loop_num; j++)
+    for(uint64_t r = 0; r < loop_num; r++)
     {
-        /* If key not found in map iterator to end is returned */ 
+        j = DLOG_spiral(center, r, loop_num); 
+        EC_POINT* searchpoint = (j >= center) ? searchpoint_up : searchpoint_down; 
 
         // convert the search point to binary form
-        EC_POINT_point2oct(group, searchpoint, POINT_CONVERSION_COMPRESSED, buffer+(j*POINT_LEN), POINT_LEN, bn_ctx);  
-        // map the binary expression to string
-        ecp_str.assign(reinterpret_cast<char*>(buffer+(j*POINT_LEN)), POINT_LEN); 
+        memset(buffer, 0, POINT_LEN); 
+        EC_POINT_point2oct(group, searchpoint, POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, bn_ctx);  
         
         // baby-step search in the hash map
-        if (point2index_map.find(ecp_str) == point2index_map.end())
+        if (HASHMAP_find(buffer, i, HASHMAP_step_bound(giantstep_size, range_size, j)) == false)
         {
-            //EC_POINT_sub(searchpoint, searchpoint, giantstep); // not found, take a giant-step 
-            EC_POINT_add(group, searchpoint, searchpoint, ECP_giantstep, bn_ctx); // not found, take a giant-step     
+            // not found, take a giant-step away from the center 
+            if(j >= center) EC_POINT_add(group, searchpoint, searchpoint, ECP_giantstep, bn_ctx); 
+            else EC_POINT_add(group, searchpoint, searchpoint, ECP_giantstep_back, bn_ctx); 
         }
         else{
-            i = point2index_map[ecp_str]; 
             finding = true; 
             break;
         }
@@ -189,10 +636,12 @@ bool Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, size_t RANGE_LEN, size_
         cout << "the DLOG is not found in the specified range" << endl; 
     } 
 
-    delete[] buffer; 
     EC_POINT_free(ECP_giantstep); 
-    EC_POINT_free(searchpoint); 
+    EC_POINT_free(ECP_giantstep_back); 
+    EC_POINT_free(searchpoint_up); 
+    EC_POINT_free(searchpoint_down); 
     BN_free(BN_giantstep_size); 
+    BN_free(BN_center); 
     
     return finding; 
 }
@@ -200,130 +649,513 @@ bool Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, size_t RANGE_LEN, size_
 /* parallel implementation: include parallel serialization and decryption */
 
 
-/* parallelizable serialize task */
-void ECP_vector_serialize(EC_POINT *&g, EC_POINT *&ECP_startpoint, uint64_t &startindex, 
-                          uint64_t &length, unsigned char* buffer)
-{    
-    for(auto i = 0; i < length; i++)
+/* 
+    The hash map file is generated in chunks of HASHMAP_CHUNK_LEN entries: 
+    IO threads take chunks from a shared counter, and every finished chunk is written to its place in 
+    hashmap_file.partial and then recorded in hashmap_file.checkpoint. An interrupted generation resumes 
+    with the chunks missing in the checkpoint, and hashmap_file.partial is renamed to hashmap_file once complete. 
+*/
+
+const uint64_t HASHMAP_CHUNK_LEN = 1 << 16;  // number of entries in one chunk
+const uint64_t HASHMAP_STRAND_NUM = 256;     // number of points advanced together by batched affine additions
+
+/* progress callback: (entries done, entries in total, estimated remaining time in seconds) */
+typedef std::function<void(uint64_t, uint64_t, double)> HASHMAP_Progress; 
+
+/* 
+    compute the compressed form of g^i for i in [chunk_start, chunk_end) into buffer
+    The chunk is cut into HASHMAP_STRAND_NUM strands of consecutive indices. In each round all strands add g 
+    in affine coordinates (Montgomery form), and the slope denominators of all strands share one field inversion 
+    via Montgomery's trick. Index 0 (infinity) and 1 (which would need a doubling) are encoded directly. 
+*/
+void HASHMAP_chunk_serialize(EC_POINT *&g, uint64_t chunk_start, uint64_t chunk_end, 
+                             unsigned char *buffer, BN_CTX *ctx)
+{
+    memset(buffer, 0, (chunk_end - chunk_start)*POINT_LEN); 
+    uint64_t start = max<uint64_t>(chunk_start, 2); 
+    for(auto i = chunk_start; i < min<uint64_t>(chunk_end, 2); i++)
     {
-        EC_POINT_point2oct(group, ECP_startpoint, POINT_CONVERSION_COMPRESSED, 
-                           buffer+((startindex+i)*POINT_LEN), POINT_LEN, NULL); 
-        EC_POINT_add(group, ECP_startpoint, ECP_startpoint, g, NULL); 
-    } 
+        if(i == 1) EC_POINT_point2oct(group, g, POINT_CONVERSION_COMPRESSED, 
+                                      buffer+((i-chunk_start)*POINT_LEN), POINT_LEN, ctx); 
+    }
+    if(start >= chunk_end) return; 
+
+    uint64_t n = chunk_end - start; 
+    uint64_t strand_len = (n + HASHMAP_STRAND_NUM - 1)/HASHMAP_STRAND_NUM; 
+    uint64_t strand_num = (n + strand_len - 1)/strand_len; 
+
+    BN_CTX_start(ctx); 
+    BIGNUM *p = BN_CTX_get(ctx); 
+    BIGNUM *gx = BN_CTX_get(ctx); 
+    BIGNUM *gy = BN_CTX_get(ctx); 
+    BIGNUM *lambda = BN_CTX_get(ctx); 
+    BIGNUM *inverse = BN_CTX_get(ctx); 
+    BIGNUM *temp = BN_CTX_get(ctx); 
+    EC_GROUP_get_curve(group, p, NULL, NULL, ctx); 
+    BN_MONT_CTX *mont = BN_MONT_CTX_new(); 
+    BN_MONT_CTX_set(mont, p, ctx); 
+
+    vector<BIGNUM *> x(strand_num), y(strand_num), d(strand_num), prefix(strand_num); 
+    BN_vec_new(x); BN_vec_new(y); BN_vec_new(d); BN_vec_new(prefix); 
+
+    // strand s starts at g^{start + s*strand_len} 
+    vector<EC_POINT *> ECP_strand(strand_num); 
+    ECP_vec_new(ECP_strand); 
+    EC_POINT *ECP_strandstep = EC_POINT_new(group); 
+    BN_set_word(temp, start); 
+    EC_POINT_mul(group, ECP_strand[0], NULL, g, temp, ctx); 
+    BN_set_word(temp, strand_len); 
+    EC_POINT_mul(group, ECP_strandstep, NULL, g, temp, ctx); 
+    for(auto s = 1; s < strand_num; s++){
+        EC_POINT_add(group, ECP_strand[s], ECP_strand[s-1], ECP_strandstep, ctx); 
+    }
+    EC_POINTs_make_affine(group, strand_num, ECP_strand.data(), ctx); 
+    for(auto s = 0; s < strand_num; s++)
+    {
+        EC_POINT_get_affine_coordinates(group, ECP_strand[s], x[s], y[s], ctx); 
+        BN_to_montgomery(x[s], x[s], mont, ctx); 
+        BN_to_montgomery(y[s], y[s], mont, ctx); 
+    }
+    EC_POINT_get_affine_coordinates(group, g, gx, gy, ctx); 
+    BN_to_montgomery(gx, gx, mont, ctx); 
+    BN_to_montgomery(gy, gy, mont, ctx); 
+
+    for(uint64_t r = 0; r < strand_len; r++)
+    {
+        // emit the current point of each strand
+        uint64_t alive_num = (start + (strand_num-1)*strand_len + r < chunk_end) ? strand_num : strand_num-1; 
+        for(auto s = 0; s < alive_num; s++)
+        {
+            unsigned char *entry = buffer + (start + s*strand_len + r - chunk_start)*POINT_LEN; 
+            BN_from_montgomery(temp, y[s], mont, ctx); 
+            entry[0] = BN_is_odd(temp) ? 0x03 : 0x02; 
+            BN_from_montgomery(temp, x[s], mont, ctx); 
+            BN_bn2binpad(temp, entry+1, POINT_LEN-1); 
+        }
+        if(r+1 == strand_len) break; 
+        uint64_t step_num = (start + (strand_num-1)*strand_len + r+1 < chunk_end) ? strand_num : strand_num-1; 
+        if(step_num == 0) break; 
+
+        // invert d[s] = gx - x[s] for all strands at once
+        for(auto s = 0; s < step_num; s++)
+        {
+            BN_mod_sub_quick(d[s], gx, x[s], p); 
+            if(s == 0) BN_copy(prefix[0], d[0]); 
+            else BN_mod_mul_montgomery(prefix[s], prefix[s-1], d[s], mont, ctx); 
+        }
+        BN_from_montgomery(inverse, prefix[step_num-1], mont, ctx); 
+        BN_mod_inverse(inverse, inverse, p, ctx); 
+        BN_to_montgomery(inverse, inverse, mont, ctx); 
+
+        for(int64_t s = step_num-1; s >= 0; s--)
+        {
+            // lambda = (gy - y)/(gx - x)
+            if(s > 0){
+                BN_mod_mul_montgomery(temp, inverse, prefix[s-1], mont, ctx); 
+                BN_mod_mul_montgomery(inverse, inverse, d[s], mont, ctx); 
+            }
+            else BN_copy(temp, inverse); 
+            BN_mod_sub_quick(lambda, gy, y[s], p); 
+            BN_mod_mul_montgomery(lambda, lambda, temp, mont, ctx); 
+
+            // x' = lambda^2 - x - gx, y' = lambda (x - x') - y
+            BN_mod_mul_montgomery(temp, lambda, lambda, mont, ctx); 
+            BN_mod_sub_quick(temp, temp, x[s], p); 
+            BN_mod_sub_quick(temp, temp, gx, p); 
+            BN_mod_sub_quick(x[s], x[s], temp, p); 
+            BN_mod_mul_montgomery(x[s], x[s], lambda, mont, ctx); 
+            BN_mod_sub_quick(y[s], x[s], y[s], p); 
+            BN_copy(x[s], temp); 
+        }
+    }
+
+    BN_vec_free(x); BN_vec_free(y); BN_vec_free(d); BN_vec_free(prefix); 
+    ECP_vec_free(ECP_strand); 
+    EC_POINT_free(ECP_strandstep); 
+    BN_MONT_CTX_free(mont); 
+    BN_CTX_end(ctx); 
 }
 
+/* the shared state of a table generation */
+struct HASHMAP_Job
+{
+    vector<uint64_t> chunk;         // chunks to be generated
+    std::atomic<uint64_t> cursor;   // the next chunk to be taken
+    uint64_t start_index, end_index; 
+    uint64_t done_num;              // entries that have been written
+    uint64_t resumed_num;           // entries found in the checkpoint
+    std::mutex file_lock; 
+    fstream fout; 
+    ofstream fcheckpoint; 
+    HASHMAP_Progress progress; 
+    chrono::steady_clock::time_point start_time; 
+};
 
-/* build the hash map */
-void Parallel_HASHMAP_serialize(EC_POINT *&g, string hashmap_file, size_t RANGE_LEN, 
-                                size_t TUNNING, uint64_t IO_THREAD_NUM)
+/* parallelizable serialize task: generate and stream the chunks */
+void HASHMAP_serialize_task(EC_POINT *&g, HASHMAP_Job &job)
+{    
+    BN_CTX *ctx = BN_CTX_new(); 
+    unsigned char *buffer = new unsigned char[HASHMAP_CHUNK_LEN*POINT_LEN]; 
+
+    uint64_t k; 
+    while((k = job.cursor++) < job.chunk.size())
+    {
+        uint64_t chunk_start = max(job.chunk[k]*HASHMAP_CHUNK_LEN, job.start_index); 
+        uint64_t chunk_end = min((job.chunk[k]+1)*HASHMAP_CHUNK_LEN, job.end_index); 
+        HASHMAP_chunk_serialize(g, chunk_start, chunk_end, buffer, ctx); 
+
+        job.file_lock.lock(); 
+        job.fout.seekp(chunk_start*POINT_LEN); 
+        job.fout.write(reinterpret_cast<char *>(buffer), (chunk_end-chunk_start)*POINT_LEN); 
+        job.fout.flush(); // the chunk is on disk before it is recorded
+        job.fcheckpoint.write(reinterpret_cast<char *>(&job.chunk[k]), sizeof(uint64_t)); 
+        job.fcheckpoint.flush(); 
+        job.done_num += chunk_end - chunk_start; 
+        if(job.progress)
+        {
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - job.start_time).count(); 
+            double speed = (job.done_num - job.resumed_num)/elapsed; 
+            uint64_t total_num = job.end_index - job.start_index; 
+            job.progress(job.done_num, total_num, (total_num - job.done_num)/speed); 
+        }
+        job.file_lock.unlock(); 
+    }
+
+    delete[] buffer; 
+    BN_CTX_free(ctx); 
+}
+
+/* 
+    generate the entries [start_index, end_index) of hashmap_file in parallel, 
+    the entries [0, start_index) are expected in hashmap_file.partial already
+*/
+void Parallel_HASHMAP_generate(EC_POINT *&g, string hashmap_file, uint64_t start_index, uint64_t end_index, 
+                               uint64_t IO_THREAD_NUM, HASHMAP_Progress progress = nullptr)
 {
-    cout << "hash map does not exist, begin to build and serialize >>>" << endl; 
+    string partial_file = hashmap_file + ".partial"; 
+    string checkpoint_file = hashmap_file + ".checkpoint"; 
 
-    auto start_time = chrono::steady_clock::now(); // start to count the time
-    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); // giantstep size
+    // the checkpoint header identifies the job: (start_index, end_index, chunk length, g)
+    unsigned char header[3*sizeof(uint64_t) + POINT_LEN] = {0}; 
+    uint64_t parameter[3] = {start_index, end_index, HASHMAP_CHUNK_LEN}; 
+    memcpy(header, parameter, sizeof(parameter)); 
+    EC_POINT_point2oct(group, g, POINT_CONVERSION_COMPRESSED, header+sizeof(parameter), POINT_LEN, NULL); 
 
-    BIGNUM *BN_range = BN_new(); 
+    HASHMAP_Job job; 
+    job.start_index = start_index; 
+    job.end_index = end_index; 
+    job.done_num = 0; 
+    job.progress = progress; 
 
-    if(giantstep_size%IO_THREAD_NUM != 0)
+    // resume from the checkpoint if it belongs to the same job
+    vector<bool> chunk_done((end_index + HASHMAP_CHUNK_LEN - 1)/HASHMAP_CHUNK_LEN, false); 
+    bool resume = false; 
+    if(FILE_exist(checkpoint_file) && FILE_exist(partial_file))
     {
-        cout << "thread assignment fails" << endl; 
-        exit(EXIT_FAILURE); 
+        ifstream fin(checkpoint_file, ios::binary); 
+        unsigned char stored_header[sizeof(header)]; 
+        fin.read(reinterpret_cast<char *>(stored_header), sizeof(header)); 
+        if(fin && memcmp(header, stored_header, sizeof(header)) == 0)
+        {
+            resume = true; 
+            uint64_t k; 
+            while(fin.read(reinterpret_cast<char *>(&k), sizeof(uint64_t))){
+                if(k < chunk_done.size()) chunk_done[k] = true; 
+            }
+        }
+        fin.close(); 
+    }
+    if(resume == false)
+    {
+        if(start_index == 0) ofstream(partial_file, ios::binary).close(); // create an empty partial file
+        ofstream fcheckpoint(checkpoint_file, ios::binary); 
+        fcheckpoint.write(reinterpret_cast<char *>(header), sizeof(header)); 
+        fcheckpoint.close(); 
     }
-    uint64_t length = giantstep_size/IO_THREAD_NUM; 
 
-    vector<EC_POINT *> ECP_startpoint(IO_THREAD_NUM); 
-    vector<uint64_t> startindex(IO_THREAD_NUM); 
-    for (auto i = 0; i < IO_THREAD_NUM; i++){
-        startindex[i] = i * length; 
-        ECP_startpoint[i] = EC_POINT_new(group);
-        BN_set_word(BN_range, startindex[i]);
-        EC_POINT_mul(group, ECP_startpoint[i], NULL, g, BN_range, bn_ctx);
-    } 
+    for(uint64_t k = start_index/HASHMAP_CHUNK_LEN; k < chunk_done.size(); k++)
+    {
+        uint64_t chunk_start = max(k*HASHMAP_CHUNK_LEN, start_index); 
+        uint64_t chunk_end = min((k+1)*HASHMAP_CHUNK_LEN, end_index); 
+        if(chunk_done[k]) job.done_num += chunk_end - chunk_start; 
+        else job.chunk.push_back(k); 
+    }
+    job.resumed_num = job.done_num; 
+    if(resume == true){
+        cout << "resume hash map generation: " << job.done_num << " of " 
+             << end_index - start_index << " entries exist" << endl; 
+    }
 
-    unsigned char *buffer = new unsigned char[giantstep_size*POINT_LEN]();
-    if(buffer == NULL)
+    job.fout.open(partial_file, ios::binary | ios::in | ios::out); 
+    job.fcheckpoint.open(checkpoint_file, ios::binary | ios::app); 
+    if(!job.fout || !job.fcheckpoint)
     {
-        cout << "fail to create buffer" << endl; 
+        cout << partial_file << " open error" << endl;
         exit(EXIT_FAILURE); 
-    } 
+    }
+    job.cursor = 0; 
+    job.start_time = chrono::steady_clock::now(); 
 
+    if(IO_THREAD_NUM == 0) IO_THREAD_NUM = 1; 
     vector<thread> initialize_task;
     for(auto i = 0; i < IO_THREAD_NUM; i++){ 
-        initialize_task.push_back(std::thread(ECP_vector_serialize, 
-                                  std::ref(g), std::ref(ECP_startpoint[i]), 
-                                  std::ref(startindex[i]), std::ref(length), std::ref(buffer)));
+        initialize_task.push_back(std::thread(HASHMAP_serialize_task, std::ref(g), std::ref(job)));
     }
-
     for(auto i = 0; i < IO_THREAD_NUM; i++){ 
         initialize_task[i].join(); 
     }    
 
-    // serialize buffer to hashmap_file
-    ofstream fout; 
-    fout.open(hashmap_file, ios::binary); 
-    if(!fout)
+    job.fout.close(); 
+    job.fcheckpoint.close(); 
+    if(rename(partial_file.c_str(), hashmap_file.c_str()) != 0)
     {
-        cout << hashmap_file << " open error" << endl;
-        exit(1); 
+        cout << hashmap_file << " rename error" << endl;
+        exit(EXIT_FAILURE); 
     }
-    fout.write(reinterpret_cast<char *>(buffer), giantstep_size*POINT_LEN); 
-    fout.close(); 
-    delete[] buffer; 
+    remove(checkpoint_file.c_str()); 
+}
+
+/* build the hash map */
+void Parallel_HASHMAP_serialize(EC_POINT *&g, string hashmap_file, size_t RANGE_LEN, 
+                                size_t TUNNING, uint64_t IO_THREAD_NUM, HASHMAP_Progress progress = nullptr)
+{
+    cout << "hash map does not exist, begin to build and serialize >>>" << endl; 
+
+    auto start_time = chrono::steady_clock::now(); // start to count the time
+    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); // giantstep size
+
+    Parallel_HASHMAP_generate(g, hashmap_file, 0, giantstep_size, IO_THREAD_NUM, progress); 
         
     auto end_time = chrono::steady_clock::now(); // end to count the time
     auto running_time = end_time - start_time;
     cout << "hash map building and serializing takes time = " 
         << chrono::duration <double, milli> (running_time).count() << " ms" << endl;
-    
-    BN_free(BN_range); 
-    for (auto i = 0; i < IO_THREAD_NUM; i++){
-        EC_POINT_free(ECP_startpoint[i]);  
-    } 
 }
 
-/* parallelizable search task */
-void search_index(EC_POINT *&ECP_searchpoint, EC_POINT *&ECP_giantstep, 
-                  uint64_t &sliced_loop_num, uint64_t &i, uint64_t &j, 
-                  int &finding, int &parallel_finding)
-{    
-    string ecp_str; 
-    unsigned char *buffer = new unsigned char[sliced_loop_num*POINT_LEN](); 
-    if (buffer == NULL)
+/*
+    build hashmap_file, or extend an existing hashmap_file to 2^{RANGE_LEN/2 + TUNNING} entries:
+    the stored entries g^0, ..., g^{k-1} are kept and only g^k, ... are generated, so raising TUNNING
+    costs the new entries only. A larger file is left as it is (loading uses its prefix).
+    An interrupted extension resumes from hashmap_file.partial and hashmap_file.checkpoint.
+*/
+void Parallel_HASHMAP_grow(EC_POINT *&g, string hashmap_file, size_t RANGE_LEN,
+                           size_t TUNNING, uint64_t IO_THREAD_NUM, HASHMAP_Progress progress = nullptr)
+{
+    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); // giantstep size
+    string partial_file = hashmap_file + ".partial"; 
+    string checkpoint_file = hashmap_file + ".checkpoint"; 
+
+    uint64_t start_index = 0; 
+    // an empty hashmap_file holds no entry (and no g^{start_index - 1} to check): build as if it did not exist
+    if(FILE_exist(hashmap_file) && ifstream(hashmap_file, ios::binary | ios::ate).tellg() == 0) remove(hashmap_file.c_str()); 
+    if(FILE_exist(hashmap_file))
     {
-        cout << "fail to create buffer" << endl; 
-        delete[] buffer; 
-        exit(EXIT_FAILURE); 
-    } 
-    // giant-step and baby-step search
-    for(j = 0; j < sliced_loop_num; j++)
+        ifstream fin(hashmap_file, ios::binary); 
+        fin.seekg(0, fin.end); 
+        uint64_t FILE_LEN = fin.tellg(); 
+        if(FILE_LEN % POINT_LEN != 0)
+        {
+            cout << hashmap_file << " is not a hash map file" << endl; 
+            exit(EXIT_FAILURE); 
+        }
+        start_index = FILE_LEN/POINT_LEN; 
+        if(start_index >= giantstep_size) return; 
+
+        // the last stored entry must be g^{start_index - 1}, otherwise the file belongs to another g
+        unsigned char stored_point[POINT_LEN], expected_point[POINT_LEN] = {0}; 
+        fin.seekg((start_index-1)*POINT_LEN); 
+        fin.read(reinterpret_cast<char *>(stored_point), POINT_LEN); 
+        fin.close(); 
+        BIGNUM *BN_index = BN_new(); 
+        BN_set_word(BN_index, start_index-1); 
+        EC_POINT *ECP_last = EC_POINT_new(group); 
+        EC_POINT_mul(group, ECP_last, NULL, g, BN_index, NULL); 
+        if(EC_POINT_is_at_infinity(group, ECP_last) == 0){
+            EC_POINT_point2oct(group, ECP_last, POINT_CONVERSION_COMPRESSED, expected_point, POINT_LEN, NULL); 
+        }
+        EC_POINT_free(ECP_last); 
+        BN_free(BN_index); 
+        if(memcmp(stored_point, expected_point, POINT_LEN) != 0)
+        {
+            cout << hashmap_file << " does not match the generator" << endl; 
+            exit(EXIT_FAILURE); 
+        }
+
+        cout << "hash map has " << start_index << " entries, begin to extend it to "
+             << giantstep_size << " entries >>>" << endl; 
+        if(rename(hashmap_file.c_str(), partial_file.c_str()) != 0)
+        {
+            cout << hashmap_file << " rename error" << endl; 
+            exit(EXIT_FAILURE); 
+        }
+    }
+    else if(FILE_exist(partial_file) && FILE_exist(checkpoint_file))
     {
-        /* If key not found in map iterator to end is returned */ 
-        if (parallel_finding == 1) break; 
-        // map the point to string
-        EC_POINT_point2oct(group, ECP_searchpoint, POINT_CONVERSION_COMPRESSED, buffer+(j*POINT_LEN), POINT_LEN, NULL);  
-        ecp_str.assign(reinterpret_cast<char*>(buffer+(j*POINT_LEN)), POINT_LEN); 
-        
-        // baby-step search in the hash map
-        if (point2index_map.find(ecp_str) == point2index_map.end())
+        // an interrupted generation: the entries before its start index are complete
+        ifstream fin(checkpoint_file, ios::binary); 
+        uint64_t parameter[3] = {0}; 
+        fin.read(reinterpret_cast<char *>(parameter), sizeof(parameter)); 
+        if(fin) start_index = min(parameter[0], giantstep_size); 
+        fin.close(); 
+    }
+    if(start_index == 0) cout << "hash map does not exist, begin to build and serialize >>>" << endl; 
+
+    auto start_time = chrono::steady_clock::now(); // start to count the time
+    Parallel_HASHMAP_generate(g, hashmap_file, start_index, giantstep_size, IO_THREAD_NUM, progress); 
+    auto end_time = chrono::steady_clock::now(); // end to count the time
+    auto running_time = end_time - start_time; 
+    cout << "hash map building and serializing takes time = "
+        << chrono::duration <double, milli> (running_time).count() << " ms" << endl; 
+}
+
+/* 
+    The parallel search splits the loop_num giant steps into chunks of DLOG_CHUNK_LEN giant steps. 
+    Each thread owns a contiguous range of unsearched chunks and takes chunks from its front; 
+    a thread running out of chunks steals the back half of the largest remaining range of the other threads, 
+    so thread number needs not divide loop_num and slow threads do not delay the search. 
+    The search stops as soon as one thread hits the hash map or the caller raises the cancel flag. 
+    The ranges hold positions rather than chunks: the chunks are visited in the spiral order around the hint, 
+    and thread t initially owns the spiral ranks t, t+T, t+2T, ... so that all T threads start next to the hint. 
+*/
+
+const uint64_t DLOG_CHUNK_LEN = 256; // number of giant steps in one chunk
+
+enum DLOG_Status {DLOG_FOUND = 0, DLOG_NOT_FOUND = 1, DLOG_CANCELLED = 2};
+
+// the range of unsearched chunks [begin, end) owned by one thread
+struct DLOG_Slice
+{
+    std::mutex lock; 
+    uint64_t begin; 
+    uint64_t end; 
+};
+
+/* the spiral rank of position s, where thread t initially owns the positions of ranks t, t+T, t+2T, ... */
+inline uint64_t DLOG_rank(uint64_t s, uint64_t chunk_num, uint64_t THREAD_NUM)
+{
+    uint64_t q = chunk_num / THREAD_NUM, rem = chunk_num % THREAD_NUM; // the first rem threads own q+1 positions
+    if(s < rem*(q+1)) return (s % (q+1))*THREAD_NUM + s/(q+1); 
+    s -= rem*(q+1); 
+    return (s % q)*THREAD_NUM + rem + s/q; 
+}
+
+/* take one chunk: first from the own slice, otherwise steal the back half of the largest slice */
+bool DLOG_next_chunk(vector<DLOG_Slice> &slice, uint64_t t, uint64_t &chunk)
+{
+    while(true)
+    {
+        slice[t].lock.lock(); 
+        if(slice[t].begin < slice[t].end)
         {
-            //EC_POINT_sub_without_bnctx(searchpoint, searchpoint, giantstep); // not found, take a giant-step forward   
-            EC_POINT_add(group, ECP_searchpoint, ECP_searchpoint, ECP_giantstep, NULL); // not found, take a giant-step forward   
+            chunk = slice[t].begin++; 
+            slice[t].lock.unlock(); 
+            return true; 
         }
-        else{
-            i = point2index_map[ecp_str]; 
-            finding = 1; 
-            parallel_finding = 1; 
-            break;
+        slice[t].lock.unlock(); 
+
+        // pick the victim with the most unsearched chunks
+        uint64_t victim = t, max_remain = 0; 
+        for(auto k = 0; k < slice.size(); k++)
+        {
+            slice[k].lock.lock(); 
+            uint64_t remain = slice[k].end - slice[k].begin; 
+            slice[k].lock.unlock(); 
+            if(remain > max_remain){
+                max_remain = remain; 
+                victim = k; 
+            }
         }
+        if(max_remain == 0) return false; // all chunks are taken
+
+        uint64_t begin, end; 
+        slice[victim].lock.lock(); 
+        end = slice[victim].end; 
+        begin = slice[victim].begin + (end - slice[victim].begin)/2; // the victim keeps the front half 
+        if(slice[victim].begin < slice[victim].end) slice[victim].end = begin;
+        else begin = end; 
+        slice[victim].lock.unlock(); 
+
+        if(begin == end) continue; // the victim has finished meanwhile, try again
+        slice[t].lock.lock(); 
+        slice[t].begin = begin; 
+        slice[t].end = end; 
+        slice[t].lock.unlock(); 
     }
-    delete[] buffer; 
 }
 
-bool Parallel_Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, 
-                          size_t RANGE_LEN, size_t TUNNING, uint64_t DEC_THREAD_NUM)
+/* parallelizable search task: search chunks until found, cancelled or no chunk is left */
+void search_index(EC_POINT *&h, EC_POINT *&ECP_giantstep, uint64_t &giantstep_size, uint64_t &loop_num, 
+                  uint64_t &range_size, uint64_t &center_chunk, vector<DLOG_Slice> &slice, uint64_t t, uint64_t &i, uint64_t &j, 
+                  int &finding, std::atomic<int> &parallel_finding, std::atomic<bool> *cancel)
+{    
+    BN_CTX *ctx = BN_CTX_new(); 
+    BIGNUM *BN_chunk_start = BN_new(); 
+    EC_POINT *ECP_searchpoint = EC_POINT_new(group); 
+    unsigned char buffer[POINT_LEN]; 
+    uint64_t chunk_num = (loop_num + DLOG_CHUNK_LEN - 1) / DLOG_CHUNK_LEN; 
+
+    uint64_t position; 
+    while(parallel_finding.load() == 0 && DLOG_next_chunk(slice, t, position))
+    {
+        uint64_t chunk = DLOG_spiral(center_chunk, DLOG_rank(position, chunk_num, slice.size()), chunk_num); 
+        uint64_t chunk_start = chunk * DLOG_CHUNK_LEN; 
+        uint64_t chunk_end = min(chunk_start + DLOG_CHUNK_LEN, loop_num); 
+
+        // set the searchpoint to h - chunk_start*giantstep 
+        BN_set_word(BN_chunk_start, chunk_start); 
+        EC_POINT_mul(group, ECP_searchpoint, NULL, ECP_giantstep, BN_chunk_start, ctx); 
+        EC_POINT_add(group, ECP_searchpoint, ECP_searchpoint, h, ctx); 
+
+        // giant-step and baby-step search
+        for(uint64_t k = chunk_start; k < chunk_end; k++)
+        {
+            if (parallel_finding.load(std::memory_order_relaxed) != 0) break; 
+            if (cancel != NULL && cancel->load(std::memory_order_relaxed) == true)
+            {
+                parallel_finding = -1; 
+                break; 
+            }
+            // convert the search point to binary form
+            memset(buffer, 0, POINT_LEN); 
+            EC_POINT_point2oct(group, ECP_searchpoint, POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, ctx);  
+        
+            // baby-step search in the hash map
+            if (HASHMAP_find(buffer, i, HASHMAP_step_bound(giantstep_size, range_size, k)) == false)
+            {
+                EC_POINT_add(group, ECP_searchpoint, ECP_searchpoint, ECP_giantstep, ctx); // not found, take a giant-step forward   
+            }
+            else{
+                j = k; 
+                finding = 1; 
+                parallel_finding = 1; 
+                break;
+            }
+        }
+    }
+
+    EC_POINT_free(ECP_searchpoint); 
+    BN_free(BN_chunk_start); 
+    BN_CTX_free(ctx); 
+}
+
+/* 
+    compute x s.t. g^x = h with DEC_THREAD_NUM threads (any positive number)
+    the search can be stopped by setting *cancel = true from another thread, 
+    it starts at the chunk of the expected value hint and spirals outward
+*/
+DLOG_Status Parallel_Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, 
+                                 size_t RANGE_LEN, size_t TUNNING, uint64_t DEC_THREAD_NUM, 
+                                 std::atomic<bool> *cancel = NULL, uint64_t hint = 0)
 {
-    uint64_t giantstep_size = pow(2, RANGE_LEN/2 + TUNNING); 
-    uint64_t loop_num  = pow(2, RANGE_LEN/2 - TUNNING); 
+    // check if the hash map is empty
+    if(HASHMAP_empty() == true)
+    {
+        cout << "the hashmap is empty" << endl; 
+        exit (EXIT_FAILURE);
+    }
+    uint64_t giantstep_size, loop_num, range_size; // the loaded prefix during warm-up
+    HASHMAP_steps(RANGE_LEN, TUNNING, giantstep_size, loop_num, range_size); 
+    if(DEC_THREAD_NUM == 0) DEC_THREAD_NUM = 1; 
 
     /* compute the giantstep */
     EC_POINT* ECP_giantstep = EC_POINT_new(group); 
@@ -331,83 +1163,280 @@ bool Parallel_Shanks_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h,
     BN_set_word(BN_giantstep_size, giantstep_size);
     EC_POINT_mul(group, ECP_giantstep, NULL, g, BN_giantstep_size, bn_ctx); // set giantstep = g^giantstep_size
     EC_POINT_invert(group, ECP_giantstep, bn_ctx);
- 
-    uint64_t sliced_loop_num = loop_num/DEC_THREAD_NUM; 
-    if(loop_num%DEC_THREAD_NUM != 0)
+    EC_POINT_make_affine(group, ECP_giantstep, bn_ctx); 
+
+    /* assign the positions as the initial slices: the first chunk_num % DEC_THREAD_NUM threads own one more */
+    uint64_t chunk_num = (loop_num + DLOG_CHUNK_LEN - 1) / DLOG_CHUNK_LEN; 
+    uint64_t center_chunk = DLOG_center(hint, giantstep_size, loop_num) / DLOG_CHUNK_LEN; 
+    vector<DLOG_Slice> slice(DEC_THREAD_NUM); 
+    uint64_t position = 0; 
+    for(auto t = 0; t < DEC_THREAD_NUM; t++)
     {
-        cout << "thread assignment fails" << endl; 
-        exit(EXIT_FAILURE); 
+        slice[t].begin = position; 
+        position += chunk_num / DEC_THREAD_NUM + (t < chunk_num % DEC_THREAD_NUM ? 1 : 0); 
+        slice[t].end = position; 
     }
-    BIGNUM* BN_sliced_loop_num = BN_new();
-    BN_set_word(BN_sliced_loop_num, sliced_loop_num);
-
-    EC_POINT* ECP_smallscale = EC_POINT_new(group); 
-    EC_POINT_mul(group, ECP_smallscale, NULL, ECP_giantstep, BN_sliced_loop_num, bn_ctx);
 
     /* begin to search */
     vector<uint64_t> i_index(DEC_THREAD_NUM); 
     vector<uint64_t> j_index(DEC_THREAD_NUM);
-
-    // initialize searchpoint vector
-    vector<EC_POINT*> ECP_searchpoint(DEC_THREAD_NUM);
-    for (auto i = 0; i < DEC_THREAD_NUM; i++){
-        ECP_searchpoint[i] = EC_POINT_new(group);         
-    }   
-     
-    EC_POINT_copy(ECP_searchpoint[0], h);
-    for (auto i = 1; i < DEC_THREAD_NUM; i++){
-        EC_POINT_add(group, ECP_searchpoint[i], ECP_searchpoint[i-1], ECP_smallscale, bn_ctx);         
-    }
-    
     vector<int> finding(DEC_THREAD_NUM, 0); 
-    int parallel_finding = 0; 
-
-    // check if the hash map is empty
-    if(point2index_map.empty() == true)
-    {
-        cout << "the hashmap is empty" << endl; 
-        exit (EXIT_FAILURE);
-    }
+    std::atomic<int> parallel_finding(0); // 1: found, -1: cancelled
 
     vector<thread> searchtask;
-    for(auto i = 0; i < DEC_THREAD_NUM; i++){ 
-        searchtask.push_back(std::thread(search_index, std::ref(ECP_searchpoint[i]), 
-                             std::ref(ECP_giantstep), std::ref(sliced_loop_num), 
-                             std::ref(i_index[i]), std::ref(j_index[i]), 
-                             std::ref(finding[i]), std::ref(parallel_finding)));
+    for(auto t = 0; t < DEC_THREAD_NUM; t++){ 
+        searchtask.push_back(std::thread(search_index, std::ref(h), std::ref(ECP_giantstep), 
+                             std::ref(giantstep_size), std::ref(loop_num), std::ref(range_size), std::ref(center_chunk), 
+                             std::ref(slice), t, std::ref(i_index[t]), std::ref(j_index[t]), 
+                             std::ref(finding[t]), std::ref(parallel_finding), cancel));
     }
-
-    for(auto i = 0; i < DEC_THREAD_NUM; i++){ 
-        searchtask[i].join(); 
+    for(auto t = 0; t < DEC_THREAD_NUM; t++){ 
+        searchtask[t].join(); 
     }    
 
-    BIGNUM* BN_i = BN_new();
-    BIGNUM* BN_j = BN_new();
-
-    for(auto i = 0; i < DEC_THREAD_NUM; i++)
+    DLOG_Status status = DLOG_NOT_FOUND; 
+    if(parallel_finding.load() == -1) status = DLOG_CANCELLED; 
+    for(auto t = 0; t < DEC_THREAD_NUM; t++)
     { 
-        if(finding[i] == 1)
+        if(finding[t] == 1)
         {
-            BN_set_word(BN_i, i_index[i]); 
-            BN_set_word(BN_j, j_index[i]+i*sliced_loop_num);             
+            BIGNUM* BN_i = BN_new();
+            BIGNUM* BN_j = BN_new();
+            BN_set_word(BN_i, i_index[t]); 
+            BN_set_word(BN_j, j_index[t]);             
+            BN_mul(BN_j, BN_j, BN_giantstep_size, bn_ctx); 
+            BN_add(x, BN_i, BN_j); // x = i + j*giantstep_size; 
+            BN_free(BN_i); 
+            BN_free(BN_j);
+            status = DLOG_FOUND; 
+            break; 
         }
     }  
 
-    BN_mul(BN_j, BN_j, BN_giantstep_size, bn_ctx); 
-    BN_add(x, BN_i, BN_j); // x = i + j*giantstep_size; 
+    EC_POINT_free(ECP_giantstep); 
+    BN_free(BN_giantstep_size); 
+
+    return status; 
+}
+
+/* batch implementation: solve many DLOGs w.r.t. the same g against the same hash map */
+
+/*
+    All targets walk the same giant-step schedule in lockstep. 
+    In each round the search points of the alive targets are normalized together via EC_POINTs_make_affine, 
+    which costs one field inversion for the whole round instead of one inversion per point2oct call. 
+    A target retires as soon as it hits the hash map, so the rounds shrink as the batch gets solved. 
+    Round r visits the r-th giant step of the spiral around the center of each target (see DLOG_spiral). 
+*/
+
+/* batch search task: solve the targets vec_h[start_index, end_index) starting at the giant steps vec_center */
+void search_index_batch(EC_POINT *&ECP_giantstep, vector<EC_POINT *> &vec_h, 
+                        uint64_t start_index, uint64_t end_index, 
+                        uint64_t &giantstep_size, uint64_t &loop_num, uint64_t &range_size, vector<uint64_t> &vec_center, 
+                        vector<BIGNUM *> &vec_x, vector<int> &vec_finding, BN_CTX *ctx)
+{
+    EC_POINT *ECP_giantstep_back = EC_POINT_new(group); 
+    EC_POINT_copy(ECP_giantstep_back, ECP_giantstep); 
+    EC_POINT_invert(group, ECP_giantstep_back, ctx); 
+    BIGNUM *BN_center = BN_new(); 
+
+    vector<EC_POINT *> ECP_up;          // search points of the alive targets at the next giant step >= center
+    vector<EC_POINT *> ECP_down;        // search points of the alive targets at the next giant step < center
+    vector<EC_POINT *> ECP_searchpoint; // search points of the alive targets in this round
+    vector<uint64_t> alive_index;       // the index of alive targets in vec_h
+    for(auto k = start_index; k < end_index; k++)
+    {
+        EC_POINT *searchpoint_up = EC_POINT_new(group); 
+        EC_POINT *searchpoint_down = EC_POINT_new(group); 
+        BN_set_word(BN_center, vec_center[k]); 
+        EC_POINT_mul(group, searchpoint_up, NULL, ECP_giantstep, BN_center, ctx); 
+        EC_POINT_add(group, searchpoint_up, searchpoint_up, vec_h[k], ctx); // set the searchpoint to h - center*giantstep_size
+        EC_POINT_add(group, searchpoint_down, searchpoint_up, ECP_giantstep_back, ctx); 
+        ECP_up.push_back(searchpoint_up); 
+        ECP_down.push_back(searchpoint_down); 
+        alive_index.push_back(k); 
+        vec_finding[k] = 0; 
+    }
+    ECP_searchpoint.resize(ECP_up.size()); 
+
+    vector<unsigned char> buffer;   // the compressed search points of this round
+    vector<uint64_t> vec_i; 
+    vector<int> vec_hit; 
+    BIGNUM *BN_i = BN_new(); 
+    BIGNUM *BN_j = BN_new(); 
+
+    // giant-step and baby-step search: all alive targets take one giant step per round 
+    for(uint64_t r = 0; r < loop_num && alive_index.empty() == false; r++)
+    {
+        for(auto k = 0; k < alive_index.size(); k++)
+        {
+            uint64_t center = vec_center[alive_index[k]]; 
+            ECP_searchpoint[k] = (DLOG_spiral(center, r, loop_num) >= center) ? ECP_up[k] : ECP_down[k]; 
+        }
+        EC_POINTs_make_affine(group, alive_index.size(), ECP_searchpoint.data(), ctx); 
+
+        buffer.assign(alive_index.size()*POINT_LEN, 0); // the point at infinity is encoded as a single zero byte
+        for(auto k = 0; k < alive_index.size(); k++){
+            EC_POINT_point2oct(group, ECP_searchpoint[k], POINT_CONVERSION_COMPRESSED, 
+                               buffer.data()+k*POINT_LEN, POINT_LEN, ctx); 
+        }
+        vec_i.resize(alive_index.size()); 
+        vec_hit.resize(alive_index.size()); 
+        HASHMAP_probe_batch(buffer.data(), alive_index.size(), vec_i.data(), vec_hit.data(), giantstep_size); 
 
+        // backwards, so that a retired target is replaced by one that is done with this round
+        for(auto k = alive_index.size(); k-- > 0; )
+        {
+            uint64_t center = vec_center[alive_index[k]]; 
+            uint64_t j = DLOG_spiral(center, r, loop_num); 
+            // the prefix probe ignores j: a hit past the range of the complete table is a miss
+            if(vec_hit[k] == 0 || vec_i[k] >= HASHMAP_step_bound(giantstep_size, range_size, j))
+            {
+                // not found, take a giant-step away from the center
+                if(j >= center) EC_POINT_add(group, ECP_up[k], ECP_up[k], ECP_giantstep, ctx); 
+                else EC_POINT_add(group, ECP_down[k], ECP_down[k], ECP_giantstep_back, ctx); 
+            }
+            else{
+                uint64_t index = alive_index[k]; 
+                BN_set_word(BN_i, vec_i[k]); 
+                BN_set_word(BN_j, j); 
+                BN_set_word(vec_x[index], giantstep_size); 
+                BN_mul(vec_x[index], vec_x[index], BN_j, ctx); 
+                BN_add(vec_x[index], vec_x[index], BN_i); // x = i + j*giantstep_size
+                vec_finding[index] = 1; 
+
+                // retire the target: move the last alive target to its place 
+                EC_POINT_free(ECP_up[k]); 
+                EC_POINT_free(ECP_down[k]); 
+                ECP_up[k] = ECP_up.back(); 
+                ECP_down[k] = ECP_down.back(); 
+                alive_index[k] = alive_index.back(); 
+                ECP_up.pop_back(); 
+                ECP_down.pop_back(); 
+                alive_index.pop_back(); 
+            }
+        }
+    }
+
+    for(auto k = 0; k < alive_index.size(); k++){
+        EC_POINT_free(ECP_up[k]); 
+        EC_POINT_free(ECP_down[k]); 
+    }
+    EC_POINT_free(ECP_giantstep_back); 
+    BN_free(BN_center); 
     BN_free(BN_i); 
-    BN_free(BN_j);
+    BN_free(BN_j); 
+}
+
+/* the centers of the spiral search for the targets with the expected values vec_hint (empty: all 0) */
+void DLOG_vec_center(vector<uint64_t> &vec_center, const vector<uint64_t> &vec_hint, uint64_t size, 
+                     uint64_t giantstep_size, uint64_t loop_num)
+{
+    if(vec_hint.empty() == false && vec_hint.size() != size)
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE); 
+    }
+    vec_center.assign(size, 0); 
+    for(auto k = 0; k < vec_hint.size(); k++){
+        vec_center[k] = DLOG_center(vec_hint[k], giantstep_size, loop_num); 
+    }
+}
+
+/* 
+    compute x[k] s.t. g^x[k] = h[k]: finding[k] = 0 indicates there is no such x[k] in specified range 
+    vec_hint optionally gives the expected value of each x[k]
+*/
+void Shanks_DLOG_Batch(vector<BIGNUM *> &vec_x, EC_POINT *&g, vector<EC_POINT *> &vec_h, 
+                       size_t RANGE_LEN, size_t TUNNING, vector<int> &vec_finding, 
+                       const vector<uint64_t> &vec_hint = vector<uint64_t>())
+{
+    if(vec_x.size() != vec_h.size())
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE); 
+    }
+    vec_finding.assign(vec_h.size(), 0); 
+
+    // check if the hash map is empty
+    if(HASHMAP_empty() == true)
+    {
+        cout << "the hashmap is empty" << endl; 
+        exit(EXIT_FAILURE);
+    }
+    uint64_t giantstep_size, loop_num, range_size; // the loaded prefix during warm-up
+    HASHMAP_steps(RANGE_LEN, TUNNING, giantstep_size, loop_num, range_size); 
+
+    /* compute the giantstep = g^{-giantstep_size} in affine form */
+    EC_POINT* ECP_giantstep = EC_POINT_new(group); 
+    BIGNUM* BN_giantstep_size = BN_new(); 
+    BN_set_word(BN_giantstep_size, giantstep_size);
+    EC_POINT_mul(group, ECP_giantstep, NULL, g, BN_giantstep_size, bn_ctx); 
+    EC_POINT_invert(group, ECP_giantstep, bn_ctx);
+    EC_POINT_make_affine(group, ECP_giantstep, bn_ctx); 
+
+    vector<uint64_t> vec_center; 
+    DLOG_vec_center(vec_center, vec_hint, vec_h.size(), giantstep_size, loop_num); 
+    search_index_batch(ECP_giantstep, vec_h, 0, vec_h.size(), giantstep_size, loop_num, range_size, 
+                       vec_center, vec_x, vec_finding, bn_ctx); 
 
     EC_POINT_free(ECP_giantstep); 
     BN_free(BN_giantstep_size); 
-    BN_free(BN_sliced_loop_num); 
+}
 
-    EC_POINT_free(ECP_smallscale); 
+/* parallel batch DLOG: the targets are evenly sliced among DEC_THREAD_NUM threads, vec_hint as above */
+void Parallel_Shanks_DLOG_Batch(vector<BIGNUM *> &vec_x, EC_POINT *&g, vector<EC_POINT *> &vec_h, 
+                                size_t RANGE_LEN, size_t TUNNING, uint64_t DEC_THREAD_NUM, 
+                                vector<int> &vec_finding, const vector<uint64_t> &vec_hint = vector<uint64_t>())
+{
+    if(vec_x.size() != vec_h.size())
+    {
+        cout << "vector size does not match!" << endl;
+        exit(EXIT_FAILURE); 
+    }
+    vec_finding.assign(vec_h.size(), 0); 
 
-    for (auto i = 0; i < DEC_THREAD_NUM; i++){
-        EC_POINT_free(ECP_searchpoint[i]);         
-    } 
+    // check if the hash map is empty
+    if(HASHMAP_empty() == true)
+    {
+        cout << "the hashmap is empty" << endl; 
+        exit(EXIT_FAILURE);
+    }
+    uint64_t giantstep_size, loop_num, range_size; // the loaded prefix during warm-up
+    HASHMAP_steps(RANGE_LEN, TUNNING, giantstep_size, loop_num, range_size); 
 
-    return true; 
-}
\ No newline at end of file
+    /* compute the giantstep = g^{-giantstep_size} in affine form */
+    EC_POINT* ECP_giantstep = EC_POINT_new(group); 
+    BIGNUM* BN_giantstep_size = BN_new(); 
+    BN_set_word(BN_giantstep_size, giantstep_size);
+    EC_POINT_mul(group, ECP_giantstep, NULL, g, BN_giantstep_size, bn_ctx); 
+    EC_POINT_invert(group, ECP_giantstep, bn_ctx);
+    EC_POINT_make_affine(group, ECP_giantstep, bn_ctx); 
+
+    vector<uint64_t> vec_center; 
+    DLOG_vec_center(vec_center, vec_hint, vec_h.size(), giantstep_size, loop_num); 
+
+    // each thread owns a BN_CTX (a BN_CTX must not be shared among threads)
+    uint64_t THREAD_NUM = min<uint64_t>(DEC_THREAD_NUM, vec_h.size()); 
+    vector<BN_CTX *> thread_ctx(THREAD_NUM); 
+    vector<thread> searchtask;
+    for(auto t = 0; t < THREAD_NUM; t++)
+    {
+        thread_ctx[t] = BN_CTX_new(); 
+        uint64_t start_index = vec_h.size() * t / THREAD_NUM; 
+        uint64_t end_index = vec_h.size() * (t+1) / THREAD_NUM; 
+        searchtask.push_back(std::thread(search_index_batch, std::ref(ECP_giantstep), std::ref(vec_h), 
+                             start_index, end_index, std::ref(giantstep_size), std::ref(loop_num), 
+                             std::ref(range_size), std::ref(vec_center), std::ref(vec_x), std::ref(vec_finding), thread_ctx[t]));
+    }
+
+    for(auto t = 0; t < THREAD_NUM; t++){ 
+        searchtask[t].join(); 
+        BN_CTX_free(thread_ctx[t]); 
+    }    
+
+    EC_POINT_free(ECP_giantstep); 
+    BN_free(BN_giantstep_size); 
+}
+
+#endif
@@ -0,0 +1,337 @@
+/****************************************************************************
+this hpp implements the calibration of the DLOG parameters on the host
+*****************************************************************************
+* @author     This file is part of PGC, developed by Yu Chen
+* @paper      https://eprint.iacr.org/2019/319
+* @copyright  MIT license (see LICENSE file)
+*****************************************************************************/
+#ifndef __DLOG_TUNING__
+#define __DLOG_TUNING__
+
+#include "../common/global.hpp"
+#include "calculate_dlog.hpp"
+#include "kangaroo_dlog.hpp"
+#include <map>
+#include <unistd.h>
+
+/*
+    TUNNING trades RAM for decryption time: the Shanks table keeps 2^{RANGE_LEN/2+TUNNING} entries
+    and a decryption takes 2^{RANGE_LEN/2-TUNNING-1} giant steps on average.
+    The calibration measures the costs of a giant step, a table probe, a table entry, the fixed part of a
+    decryption and a thread launch, then evaluates the expected latency
+        fixed + DEC_THREAD_NUM * thread + (loop_num/2) * (giantstep + probe) / DEC_THREAD_NUM
+    for every (TUNNING, DEC_THREAD_NUM) whose table fits into the RAM cap.
+    Since the latency flattens out once the fixed part dominates, the smallest table within
+    DLOG_LATENCY_SLACK of the best latency is chosen.
+*/
+
+const double DLOG_LATENCY_SLACK = 1.05;        // accept 5% more latency for a smaller table
+const double DLOG_MEMORY_SHARE = 0.75;         // share of the available RAM used when no cap is given
+const uint64_t DLOG_PROBE_REGION = 1 << 26;    // bytes of the region used to measure the probe cost
+
+struct DLOG_Profile
+{
+    size_t RANGE_LEN;
+    uint64_t MEMORY_BUDGET;   // the RAM cap (bytes) the profile is computed for
+    size_t CORE_NUM;          // hardware threads of the host
+    size_t TUNNING;
+    size_t IO_THREAD_NUM;
+    size_t DEC_THREAD_NUM;
+    int DLOG_METHOD;          // DLOG_KANGAROO if not even TUNNING = 0 fits into the RAM cap
+    double giantstep_cost;    // ns: EC add and point encoding
+    double probe_cost;        // ns: one table probe at random
+    double babystep_cost;     // ns: one table entry
+    double fixed_cost;        // ns: the scalar multiplication and inversion of a decryption
+    double thread_cost;       // ns: launch and join of a thread
+    double expected_latency;  // ms: the expected decryption time of the profile
+    double build_time;        // s: the expected table generation time of the profile
+};
+
+/* available RAM of the host or the container (cgroup v2) in bytes */
+uint64_t DLOG_available_memory()
+{
+    uint64_t available = uint64_t(sysconf(_SC_AVPHYS_PAGES)) * uint64_t(sysconf(_SC_PAGESIZE));
+    ifstream fin("/proc/meminfo");
+    string key;
+    uint64_t value;
+    string unit;
+    while(fin >> key >> value >> unit)
+    {
+        if(key == "MemAvailable:")
+        {
+            available = value * 1024;
+            break;
+        }
+    }
+    fin.close();
+
+    ifstream fmax("/sys/fs/cgroup/memory.max"), fcurrent("/sys/fs/cgroup/memory.current");
+    string limit;
+    uint64_t current;
+    if(fmax >> limit && limit != "max" && fcurrent >> current)
+    {
+        uint64_t max_len = stoull(limit);
+        if(max_len > current) available = min(available, max_len - current);
+        else available = 0;
+    }
+    return available;
+}
+
+/* ns per iteration of a giant step of the search loop */
+double DLOG_measure_giantstep(EC_POINT *&g, size_t ROUND_NUM)
+{
+    EC_POINT *ECP_searchpoint = EC_POINT_new(group);
+    EC_POINT *ECP_giantstep = EC_POINT_new(group);
+    BIGNUM *BN_step = BN_new();
+    BN_random(BN_step);
+    EC_POINT_mul(group, ECP_giantstep, NULL, g, BN_step, bn_ctx);
+    EC_POINT_make_affine(group, ECP_giantstep, bn_ctx);
+    EC_POINT_copy(ECP_searchpoint, g);
+    unsigned char buffer[POINT_LEN];
+
+    auto start_time = chrono::steady_clock::now();
+    for(auto i = 0; i < ROUND_NUM; i++)
+    {
+        memset(buffer, 0, POINT_LEN);
+        EC_POINT_point2oct(group, ECP_searchpoint, POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, bn_ctx);
+        EC_POINT_add(group, ECP_searchpoint, ECP_searchpoint, ECP_giantstep, bn_ctx);
+    }
+    auto end_time = chrono::steady_clock::now();
+
+    EC_POINT_free(ECP_searchpoint);
+    EC_POINT_free(ECP_giantstep);
+    BN_free(BN_step);
+    return chrono::duration<double, nano>(end_time - start_time).count() / ROUND_NUM;
+}
+
+volatile uint64_t DLOG_probe_sink; // the result of the probe loop, so that the compiler keeps it
+
+/* ns per random slot read in a region larger than the caches */
+double DLOG_measure_probe(size_t ROUND_NUM)
+{
+    uint64_t slot_num = DLOG_PROBE_REGION / sizeof(uint64_t);
+    vector<uint64_t> slot(slot_num);
+    for(uint64_t k = 0; k < slot_num; k++) slot[k] = k * 0x9E3779B97F4A7C15;
+
+    // each position depends on the previous read, so the reads are not overlapped
+    uint64_t position = 0;
+    auto start_time = chrono::steady_clock::now();
+    for(auto i = 0; i < ROUND_NUM; i++)
+    {
+        position = (slot[position & (slot_num-1)] ^ position) * 0xBF58476D1CE4E5B9 + i;
+    }
+    auto end_time = chrono::steady_clock::now();
+    DLOG_probe_sink = position; // keep the loop alive
+
+    return chrono::duration<double, nano>(end_time - start_time).count() / ROUND_NUM;
+}
+
+/* ns per table entry generated by HASHMAP_chunk_serialize */
+double DLOG_measure_babystep(EC_POINT *&g, size_t ROUND_NUM)
+{
+    unsigned char *buffer = new unsigned char[ROUND_NUM*POINT_LEN];
+    auto start_time = chrono::steady_clock::now();
+    HASHMAP_chunk_serialize(g, 2, 2 + ROUND_NUM, buffer, bn_ctx);
+    auto end_time = chrono::steady_clock::now();
+    delete[] buffer;
+    return chrono::duration<double, nano>(end_time - start_time).count() / ROUND_NUM;
+}
+
+/* ns for the part of a decryption that does not depend on the table: M = Y - X^{sk^{-1}} */
+double DLOG_measure_fixed(EC_POINT *&g, size_t ROUND_NUM)
+{
+    EC_POINT *M = EC_POINT_new(group);
+    BIGNUM *sk = BN_new();
+    BIGNUM *sk_inverse = BN_new();
+    BN_random(sk);
+
+    auto start_time = chrono::steady_clock::now();
+    for(auto i = 0; i < ROUND_NUM; i++)
+    {
+        BN_mod_inverse(sk_inverse, sk, order, bn_ctx);
+        EC_POINT_mul(group, M, NULL, g, sk_inverse, bn_ctx);
+        EC_POINT_add(group, M, M, g, bn_ctx);
+    }
+    auto end_time = chrono::steady_clock::now();
+
+    EC_POINT_free(M);
+    BN_free(sk);
+    BN_free(sk_inverse);
+    return chrono::duration<double, nano>(end_time - start_time).count() / ROUND_NUM;
+}
+
+/* ns to launch and join a thread */
+double DLOG_measure_thread(size_t ROUND_NUM)
+{
+    auto start_time = chrono::steady_clock::now();
+    vector<thread> task;
+    for(auto i = 0; i < ROUND_NUM; i++) task.push_back(std::thread([]{}));
+    for(auto i = 0; i < ROUND_NUM; i++) task[i].join();
+    auto end_time = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(end_time - start_time).count() / ROUND_NUM;
+}
+
+/* expected decryption time (ns) of the Shanks search with the given parameters */
+double DLOG_expected_latency(DLOG_Profile &profile, size_t TUNNING, size_t DEC_THREAD_NUM)
+{
+    double loop_num = pow(2, profile.RANGE_LEN/2 - TUNNING);
+    double chunk_num = ceil(loop_num / DLOG_CHUNK_LEN);
+    double search_time = (loop_num/2) * (profile.giantstep_cost + profile.probe_cost)
+                       + (chunk_num/2) * profile.fixed_cost; // a chunk starts with a scalar multiplication
+    return profile.fixed_cost + DEC_THREAD_NUM * profile.thread_cost + search_time / DEC_THREAD_NUM;
+}
+
+/*
+    measure the host and choose TUNNING and the thread numbers for RANGE_LEN under the RAM cap
+    MEMORY_BUDGET = 0 caps the table at DLOG_MEMORY_SHARE of the available RAM
+*/
+void DLOG_Calibrate(DLOG_Profile &profile, size_t RANGE_LEN, uint64_t MEMORY_BUDGET = 0)
+{
+    cout << "calibrate the DLOG parameters >>>" << endl;
+    auto start_time = chrono::steady_clock::now();
+
+    profile.RANGE_LEN = RANGE_LEN;
+    profile.MEMORY_BUDGET = MEMORY_BUDGET;
+    if(MEMORY_BUDGET == 0) profile.MEMORY_BUDGET = DLOG_available_memory() * DLOG_MEMORY_SHARE;
+    profile.CORE_NUM = max<size_t>(thread::hardware_concurrency(), 1);
+
+    EC_POINT *g = EC_POINT_dup(generator, group);
+    profile.giantstep_cost = DLOG_measure_giantstep(g, 1 << 13);
+    profile.probe_cost = DLOG_measure_probe(1 << 20);
+    profile.babystep_cost = DLOG_measure_babystep(g, 1 << 14);
+    profile.fixed_cost = DLOG_measure_fixed(g, 1 << 7);
+    profile.thread_cost = DLOG_measure_thread(1 << 5);
+    EC_POINT_free(g);
+
+    // the best latency of every TUNNING that fits into the RAM cap
+    vector<double> latency(RANGE_LEN/2 + 1, -1);
+    vector<size_t> thread_num(RANGE_LEN/2 + 1, 1);
+    double best_latency = -1;
+    for(size_t TUNNING = 0; TUNNING <= RANGE_LEN/2; TUNNING++)
+    {
+        uint64_t slot_num;
+        uint64_t table_len = HASHMAP_region_len(uint64_t(pow(2, RANGE_LEN/2 + TUNNING)), slot_num);
+        if(table_len > profile.MEMORY_BUDGET || RANGE_LEN/2 + TUNNING >= 32) break;
+        for(size_t DEC_THREAD_NUM = 1; DEC_THREAD_NUM <= profile.CORE_NUM; DEC_THREAD_NUM++)
+        {
+            double t = DLOG_expected_latency(profile, TUNNING, DEC_THREAD_NUM);
+            if(latency[TUNNING] < 0 || t < latency[TUNNING])
+            {
+                latency[TUNNING] = t;
+                thread_num[TUNNING] = DEC_THREAD_NUM;
+            }
+        }
+        if(best_latency < 0 || latency[TUNNING] < best_latency) best_latency = latency[TUNNING];
+    }
+
+    profile.TUNNING = 0;
+    profile.DEC_THREAD_NUM = 1;
+    profile.IO_THREAD_NUM = profile.CORE_NUM;
+    if(best_latency < 0)
+    {
+        // not even the smallest Shanks table fits: the setup falls back to kangaroo
+        profile.DLOG_METHOD = DLOG_KANGAROO;
+        profile.DEC_THREAD_NUM = profile.CORE_NUM;
+        profile.expected_latency = -1;
+        profile.build_time = -1;
+    }
+    else{
+        profile.DLOG_METHOD = DLOG_SHANKS;
+        for(size_t TUNNING = 0; TUNNING < latency.size(); TUNNING++)
+        {
+            if(latency[TUNNING] >= 0 && latency[TUNNING] <= best_latency * DLOG_LATENCY_SLACK)
+            {
+                profile.TUNNING = TUNNING;
+                profile.DEC_THREAD_NUM = thread_num[TUNNING];
+                break;
+            }
+        }
+        profile.expected_latency = latency[profile.TUNNING] / 1e6;
+        profile.build_time = pow(2, RANGE_LEN/2 + profile.TUNNING) * profile.babystep_cost / profile.IO_THREAD_NUM / 1e9;
+    }
+
+    auto end_time = chrono::steady_clock::now();
+    cout << "DLOG calibration takes time = "
+         << chrono::duration <double, milli> (end_time - start_time).count() << " ms" << endl;
+}
+
+void DLOG_Profile_print(DLOG_Profile &profile)
+{
+    cout << "DLOG profile for RANGE_LEN = " << profile.RANGE_LEN
+         << " under RAM cap = " << profile.MEMORY_BUDGET/(1 << 20) << " MB on " << profile.CORE_NUM << " cores" << endl;
+    cout << "giant step = " << profile.giantstep_cost << " ns, probe = " << profile.probe_cost
+         << " ns, table entry = " << profile.babystep_cost << " ns, fixed = " << profile.fixed_cost
+         << " ns, thread = " << profile.thread_cost << " ns" << endl;
+    if(profile.DLOG_METHOD == DLOG_KANGAROO)
+    {
+        cout << "recommend: no Shanks table fits, use kangaroo with DEC_THREAD_NUM = " << profile.DEC_THREAD_NUM << endl;
+        return;
+    }
+    cout << "recommend: TUNNING = " << profile.TUNNING << ", DEC_THREAD_NUM = " << profile.DEC_THREAD_NUM
+         << ", IO_THREAD_NUM = " << profile.IO_THREAD_NUM << endl;
+    cout << "expected decryption time = " << profile.expected_latency << " ms, table generation time = "
+         << profile.build_time << " s" << endl;
+}
+
+/* save the profile as "name value" lines */
+void DLOG_Profile_serialize(DLOG_Profile &profile, string profile_file)
+{
+    ofstream fout(profile_file);
+    if(!fout)
+    {
+        cout << profile_file << " open error" << endl;
+        exit(EXIT_FAILURE);
+    }
+    fout.precision(17);
+    fout << "RANGE_LEN " << profile.RANGE_LEN << endl;
+    fout << "MEMORY_BUDGET " << profile.MEMORY_BUDGET << endl;
+    fout << "CORE_NUM " << profile.CORE_NUM << endl;
+    fout << "TUNNING " << profile.TUNNING << endl;
+    fout << "IO_THREAD_NUM " << profile.IO_THREAD_NUM << endl;
+    fout << "DEC_THREAD_NUM " << profile.DEC_THREAD_NUM << endl;
+    fout << "DLOG_METHOD " << profile.DLOG_METHOD << endl;
+    fout << "giantstep_cost " << profile.giantstep_cost << endl;
+    fout << "probe_cost " << profile.probe_cost << endl;
+    fout << "babystep_cost " << profile.babystep_cost << endl;
+    fout << "fixed_cost " << profile.fixed_cost << endl;
+    fout << "thread_cost " << profile.thread_cost << endl;
+    fout << "expected_latency " << profile.expected_latency << endl;
+    fout << "build_time " << profile.build_time << endl;
+    fout.close();
+}
+
+/* load a saved profile: return false if the file is missing or incomplete */
+bool DLOG_Profile_deserialize(DLOG_Profile &profile, string profile_file)
+{
+    ifstream fin(profile_file);
+    if(!fin) return false;
+    map<string, double> value;
+    string key;
+    double v;
+    while(fin >> key >> v) value[key] = v;
+    fin.close();
+
+    const char *name[] = {"RANGE_LEN", "MEMORY_BUDGET", "CORE_NUM", "TUNNING", "IO_THREAD_NUM", "DEC_THREAD_NUM",
+                          "DLOG_METHOD", "giantstep_cost", "probe_cost", "babystep_cost", "fixed_cost",
+                          "thread_cost", "expected_latency", "build_time"};
+    for(auto i = 0; i < sizeof(name)/sizeof(name[0]); i++){
+        if(value.count(name[i]) == 0) return false;
+    }
+    profile.RANGE_LEN = value["RANGE_LEN"];
+    profile.MEMORY_BUDGET = value["MEMORY_BUDGET"];
+    profile.CORE_NUM = value["CORE_NUM"];
+    profile.TUNNING = value["TUNNING"];
+    profile.IO_THREAD_NUM = value["IO_THREAD_NUM"];
+    profile.DEC_THREAD_NUM = value["DEC_THREAD_NUM"];
+    profile.DLOG_METHOD = value["DLOG_METHOD"];
+    profile.giantstep_cost = value["giantstep_cost"];
+    profile.probe_cost = value["probe_cost"];
+    profile.babystep_cost = value["babystep_cost"];
+    profile.fixed_cost = value["fixed_cost"];
+    profile.thread_cost = value["thread_cost"];
+    profile.expected_latency = value["expected_latency"];
+    profile.build_time = value["build_time"];
+    return true;
+}
+
+#endif
@@ -0,0 +1,406 @@
+/****************************************************************************
+this hpp implements the Pollard kangaroo algorithm with precomputation
+*****************************************************************************
+* @author     This file is part of PGC, developed by Yu Chen
+* @paper      https://eprint.iacr.org/2019/319
+* @copyright  MIT license (see LICENSE file)
+*****************************************************************************/
+#ifndef __KANGAROO__
+#define __KANGAROO__
+
+#include "../common/global.hpp"
+#include "calculate_dlog.hpp"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <openssl/rand.h>
+
+/*
+    Pollard kangaroo (van Oorschot-Wiener) for DLOG problem with a precomputed table of distinguished points
+    (Bernstein-Lange, Computing small discrete logarithms faster):
+    given (g, h) find x \in [0, n = 2^RANGE_LEN) s.t. g^x = h, the table keeps 2^TABLE_LEN distinguished points
+
+    A kangaroo at point P jumps to P + g^{s_i}, where i is a function of P: two kangaroos landing on the same point
+    walk the same path afterwards. A point is distinguished if DP_BITS bits of its x-coordinate are zero,
+    thus a walk stops after about W = 2^DP_BITS jumps with W = sqrt(n/2^TABLE_LEN).
+    Tame kangaroos start at g^a for random a and their distinguished points are stored together with their DLOG.
+    A wild kangaroo starts at h g^delta, once it reaches a stored distinguished point the DLOG of h follows.
+
+    RAM: 2^TABLE_LEN entries (instead of 2^{RANGE_LEN/2+TUNNING} for Shanks)
+    decryption: about 2*sqrt(n/2^TABLE_LEN) jumps
+    table generation: about sqrt(n*2^TABLE_LEN) jumps (done once and serialized)
+*/
+
+const size_t KANGAROO_STEP_NUM = 64;     // number of distinct jump sizes (a power of 2)
+const size_t KANGAROO_HERD_SIZE = 64;    // number of tame kangaroos walked in lockstep by one thread
+const size_t KANGAROO_MAX_WALK = 16;     // a walk longer than KANGAROO_MAX_WALK*W jumps is regarded as trapped in a loop
+const size_t KANGAROO_MAX_RETRY = 256;   // a decryption gives up after KANGAROO_MAX_RETRY wild walks (of all threads together)
+
+const size_t KANGAROO_ENTRY_LEN = 120;   // approximate RAM cost (bytes) of one kangaroo table entry: unordered_map<string, *> with a 33-bytes key
+
+enum DLOG_Method {DLOG_SHANKS = 0, DLOG_KANGAROO = 1};
+
+/*
+    A wild walk only ends at a stored distinguished point with some probability p: it is about 0.4 inside the range
+    and drops to about 0.14 next to 2^RANGE_LEN, where fewer tame walks pass (measured for RANGE_LEN = 24, 32).
+    Kangaroo thus never proves that x is out of range: it gives up after KANGAROO_MAX_RETRY walks, which misses
+    an x in the range with probability at most 0.86^256 < 2^{-50}. 
+*/
+enum Kangaroo_Status {KANGAROO_FOUND = 0, KANGAROO_GIVEN_UP = 1};
+
+unordered_map<string, uint64_t> dp2index_map; // key-value hash table: key is a distinguished point, value is its DLOG w.r.t. g (mod 2^64)
+
+size_t KANGAROO_DP_BITS;                 // a point is distinguished if DP_BITS bits of its x-coordinate are zero
+vector<uint64_t> kangaroo_step_size;     // jump sizes s_i
+vector<EC_POINT *> kangaroo_step;        // jumps g^{s_i} in affine form
+
+/* the range mask of [0, 2^RANGE_LEN): DLOGs are computed mod 2^64, which is exact for RANGE_LEN <= 64 */
+inline uint64_t Kangaroo_range_mask(size_t RANGE_LEN)
+{
+    if(RANGE_LEN >= 64) return ~uint64_t(0);
+    else return (uint64_t(1) << RANGE_LEN) - 1;
+}
+
+/* a random integer in [1, bound] */
+inline uint64_t Kangaroo_random(uint64_t bound)
+{
+    uint64_t a;
+    RAND_bytes(reinterpret_cast<unsigned char *>(&a), sizeof(a));
+    if(bound == ~uint64_t(0)) return (a == 0) ? 1 : a;
+    return a % bound + 1;
+}
+
+/* hash of a point in compressed form: the last 8 bytes of its x-coordinate */
+inline uint64_t Kangaroo_point_hash(unsigned char *buffer)
+{
+    uint64_t hash = 0;
+    for(auto i = POINT_LEN - 8; i < POINT_LEN; i++) hash = (hash << 8) | buffer[i];
+    return hash;
+}
+
+/* a point is distinguished if the DP_BITS bits above the jump index are all zero */
+inline bool Kangaroo_is_distinguished(uint64_t hash)
+{
+    uint64_t mask = (uint64_t(1) << KANGAROO_DP_BITS) - 1;
+    return ((hash / KANGAROO_STEP_NUM) & mask) == 0;
+}
+
+/* derive the walk parameters for (g, RANGE_LEN, TABLE_LEN): jump sizes are reproducible across runs */
+void Kangaroo_Setup(EC_POINT *&g, size_t RANGE_LEN, size_t TABLE_LEN)
+{
+    if(RANGE_LEN > 64 || TABLE_LEN > RANGE_LEN)
+    {
+        cout << "kangaroo parameters are out of range" << endl;
+        exit(EXIT_FAILURE);
+    }
+    KANGAROO_DP_BITS = (RANGE_LEN - TABLE_LEN)/2;  // W = sqrt(n/2^TABLE_LEN)
+
+    // the mean jump size is n/(4W), jump sizes are uniform in [1, n/(2W)]
+    uint64_t max_step = 1;
+    if(RANGE_LEN > KANGAROO_DP_BITS + 1) max_step = uint64_t(1) << (RANGE_LEN - KANGAROO_DP_BITS - 1);
+    mt19937_64 prng(RANGE_LEN*256 + TABLE_LEN);
+
+    for(auto i = 0; i < kangaroo_step.size(); i++) EC_POINT_free(kangaroo_step[i]);
+    kangaroo_step_size.resize(KANGAROO_STEP_NUM);
+    kangaroo_step.resize(KANGAROO_STEP_NUM);
+    BIGNUM *BN_step = BN_new();
+    for(auto i = 0; i < KANGAROO_STEP_NUM; i++)
+    {
+        kangaroo_step_size[i] = prng() % max_step + 1;
+        kangaroo_step[i] = EC_POINT_new(group);
+        BN_set_word(BN_step, kangaroo_step_size[i]);
+        EC_POINT_mul(group, kangaroo_step[i], NULL, g, BN_step, NULL); // jump_i = g^{s_i}: may run on a loader thread
+    }
+    EC_POINTs_make_affine(group, KANGAROO_STEP_NUM, kangaroo_step.data(), NULL);
+    BN_free(BN_step);
+}
+
+/* parallelizable tame walk task: collect distinguished points until the table is full */
+void Kangaroo_tame_walk(EC_POINT *&g, uint64_t &range_mask, uint64_t &table_size,
+                        std::atomic<uint64_t> &table_count, std::mutex &table_mutex)
+{
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *BN_start = BN_new();
+    uint64_t max_walk = KANGAROO_MAX_WALK << KANGAROO_DP_BITS;
+
+    vector<EC_POINT *> ECP_kangaroo(KANGAROO_HERD_SIZE);
+    vector<uint64_t> start(KANGAROO_HERD_SIZE);   // tame kangaroo k starts at g^start[k]
+    vector<uint64_t> distance(KANGAROO_HERD_SIZE); // and has jumped distance[k] so far
+    vector<uint64_t> length(KANGAROO_HERD_SIZE);  // number of jumps in the current walk
+
+    for(auto k = 0; k < KANGAROO_HERD_SIZE; k++)
+    {
+        ECP_kangaroo[k] = EC_POINT_new(group);
+        start[k] = Kangaroo_random(range_mask);
+        distance[k] = 0; length[k] = 0;
+        BN_set_word(BN_start, start[k]);
+        EC_POINT_mul(group, ECP_kangaroo[k], NULL, g, BN_start, ctx);
+    }
+
+    unsigned char buffer[POINT_LEN];
+    string ecp_str;
+    while(table_count.load() < table_size)
+    {
+        // normalize the whole herd with one field inversion
+        EC_POINTs_make_affine(group, KANGAROO_HERD_SIZE, ECP_kangaroo.data(), ctx);
+        for(auto k = 0; k < KANGAROO_HERD_SIZE; k++)
+        {
+            EC_POINT_point2oct(group, ECP_kangaroo[k], POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, ctx);
+            uint64_t hash = Kangaroo_point_hash(buffer);
+            bool restart = (length[k] > max_walk);
+            if(Kangaroo_is_distinguished(hash))
+            {
+                ecp_str.assign(reinterpret_cast<char *>(buffer), POINT_LEN);
+                table_mutex.lock();
+                if(table_count.load() < table_size && dp2index_map.find(ecp_str) == dp2index_map.end())
+                {
+                    dp2index_map[ecp_str] = start[k] + distance[k];
+                    table_count++;
+                }
+                table_mutex.unlock();
+                restart = true;
+            }
+            if(restart)
+            {
+                start[k] = Kangaroo_random(range_mask);
+                distance[k] = 0; length[k] = 0;
+                BN_set_word(BN_start, start[k]);
+                EC_POINT_mul(group, ECP_kangaroo[k], NULL, g, BN_start, ctx);
+            }
+            else{
+                uint64_t i = hash % KANGAROO_STEP_NUM;
+                EC_POINT_add(group, ECP_kangaroo[k], ECP_kangaroo[k], kangaroo_step[i], ctx);
+                distance[k] += kangaroo_step_size[i];
+                length[k]++;
+            }
+        }
+    }
+
+    for(auto k = 0; k < KANGAROO_HERD_SIZE; k++) EC_POINT_free(ECP_kangaroo[k]);
+    BN_free(BN_start);
+    BN_CTX_free(ctx);
+}
+
+/* build and serialize the distinguished point table */
+void Kangaroo_Table_serialize(EC_POINT *&g, string table_file, size_t RANGE_LEN,
+                              size_t TABLE_LEN, uint64_t IO_THREAD_NUM)
+{
+    cout << "kangaroo table does not exist, begin to build and serialize >>>" << endl;
+
+    auto start_time = chrono::steady_clock::now(); // start to count the time
+    Kangaroo_Setup(g, RANGE_LEN, TABLE_LEN);
+    dp2index_map.clear();
+
+    uint64_t range_mask = Kangaroo_range_mask(RANGE_LEN);
+    uint64_t table_size = uint64_t(1) << TABLE_LEN;
+    std::atomic<uint64_t> table_count(0);
+    std::mutex table_mutex;
+
+    if(IO_THREAD_NUM == 0) IO_THREAD_NUM = 1;
+    vector<thread> walk_task;
+    for(auto i = 0; i < IO_THREAD_NUM; i++){
+        walk_task.push_back(std::thread(Kangaroo_tame_walk, std::ref(g), std::ref(range_mask),
+                            std::ref(table_size), std::ref(table_count), std::ref(table_mutex)));
+    }
+    for(auto i = 0; i < IO_THREAD_NUM; i++){
+        walk_task[i].join();
+    }
+
+    // serialize the table: header = (RANGE_LEN, TABLE_LEN, DP_BITS, entry number), entry = (point, dlog)
+    ofstream fout;
+    fout.open(table_file, ios::binary);
+    if(!fout)
+    {
+        cout << table_file << " open error" << endl;
+        exit(EXIT_FAILURE);
+    }
+    uint64_t header[4] = {RANGE_LEN, TABLE_LEN, KANGAROO_DP_BITS, dp2index_map.size()};
+    fout.write(reinterpret_cast<char *>(header), sizeof(header));
+    for(auto it = dp2index_map.begin(); it != dp2index_map.end(); it++)
+    {
+        fout.write(it->first.data(), POINT_LEN);
+        fout.write(reinterpret_cast<const char *>(&it->second), sizeof(uint64_t));
+    }
+    fout.close();
+
+    auto end_time = chrono::steady_clock::now(); // end to count the time
+    auto running_time = end_time - start_time;
+    cout << "kangaroo table building and serializing takes time = "
+        << chrono::duration <double, milli> (running_time).count() << " ms" << endl;
+}
+
+/* rebuild the distinguished point table from file */
+void Kangaroo_Table_deserialize(EC_POINT *&g, string table_file, size_t RANGE_LEN, size_t TABLE_LEN)
+{
+    cout << "kangaroo table already exists, begin to load and rebuild >>>" << endl;
+
+    auto start_time = chrono::steady_clock::now(); // start to count the time
+    Kangaroo_Setup(g, RANGE_LEN, TABLE_LEN);
+
+    ifstream fin;
+    fin.open(table_file, ios::binary);
+    if(!fin)
+    {
+        cout << table_file << " read error" << endl;
+        exit(EXIT_FAILURE);
+    }
+    uint64_t header[4];
+    fin.read(reinterpret_cast<char *>(header), sizeof(header));
+    if(!fin || header[0] != RANGE_LEN || header[1] != TABLE_LEN || header[2] != KANGAROO_DP_BITS)
+    {
+        cout << "kangaroo table parameters do not match" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t entry_num = header[3];
+    const size_t ENTRY_LEN = POINT_LEN + sizeof(uint64_t);
+    unsigned char *buffer = new unsigned char[entry_num*ENTRY_LEN]();
+    fin.read(reinterpret_cast<char *>(buffer), entry_num*ENTRY_LEN);
+    if(!fin)
+    {
+        cout << "buffer size does not match kangaroo table size" << endl;
+        exit(EXIT_FAILURE);
+    }
+    fin.close();
+
+    dp2index_map.clear();
+    dp2index_map.reserve(entry_num);
+    string str;
+    uint64_t index;
+    for(auto i = 0; i < entry_num; i++)
+    {
+        str.assign(reinterpret_cast<char *>(buffer+(i*ENTRY_LEN)), POINT_LEN);
+        memcpy(&index, buffer+(i*ENTRY_LEN)+POINT_LEN, sizeof(uint64_t));
+        dp2index_map[str] = index;
+    }
+    delete[] buffer;
+
+    auto end_time = chrono::steady_clock::now(); // end to count the time
+    auto running_time = end_time - start_time;
+    cout << "kangaroo table loading and rebuilding takes time = "
+    << chrono::duration <double, milli> (running_time).count() << " ms" << endl;
+}
+
+/* parallelizable wild walk task: x = DLOG(h) once a wild kangaroo lands on a stored distinguished point */
+void Kangaroo_wild_walk(EC_POINT *&g, EC_POINT *&h, uint64_t &range_mask, uint64_t &x,
+                        int &finding, std::atomic<int> &parallel_finding, std::atomic<uint64_t> &walk_count)
+{
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *BN_x = BN_new();
+    EC_POINT *ECP_kangaroo = EC_POINT_new(group);
+    EC_POINT *ECP_check = EC_POINT_new(group);
+    uint64_t max_walk = KANGAROO_MAX_WALK << KANGAROO_DP_BITS;
+    uint64_t max_delta = (range_mask >> 3) + 1; // wild kangaroos start at h g^delta with delta in [1, n/8]
+
+    unsigned char buffer[POINT_LEN];
+    string ecp_str;
+    while(parallel_finding.load() == 0 && walk_count++ < KANGAROO_MAX_RETRY)
+    {
+        uint64_t delta = Kangaroo_random(max_delta);
+        uint64_t distance = 0;
+        BN_set_word(BN_x, delta);
+        EC_POINT_mul(group, ECP_kangaroo, NULL, g, BN_x, ctx);
+        EC_POINT_add(group, ECP_kangaroo, ECP_kangaroo, h, ctx); // wild kangaroo starts at h g^delta
+
+        for(uint64_t length = 0; length <= max_walk; length++)
+        {
+            if(parallel_finding.load() == 1) break;
+            EC_POINT_point2oct(group, ECP_kangaroo, POINT_CONVERSION_COMPRESSED, buffer, POINT_LEN, ctx);
+            uint64_t hash = Kangaroo_point_hash(buffer);
+            if(Kangaroo_is_distinguished(hash))
+            {
+                ecp_str.assign(reinterpret_cast<char *>(buffer), POINT_LEN);
+                auto it = dp2index_map.find(ecp_str);
+                if(it != dp2index_map.end())
+                {
+                    // x + delta + distance = DLOG of the distinguished point (mod 2^64)
+                    uint64_t candidate = it->second - distance - delta;
+                    BN_set_word(BN_x, candidate);
+                    EC_POINT_mul(group, ECP_check, NULL, g, BN_x, ctx);
+                    if(candidate <= range_mask && EC_POINT_cmp(group, ECP_check, h, ctx) == 0)
+                    {
+                        x = candidate;
+                        finding = 1;
+                        parallel_finding = 1;
+                    }
+                }
+                break; // the walk ends at any distinguished point
+            }
+            uint64_t i = hash % KANGAROO_STEP_NUM;
+            EC_POINT_add(group, ECP_kangaroo, ECP_kangaroo, kangaroo_step[i], ctx);
+            distance += kangaroo_step_size[i];
+        }
+    }
+
+    EC_POINT_free(ECP_kangaroo);
+    EC_POINT_free(ECP_check);
+    BN_free(BN_x);
+    BN_CTX_free(ctx);
+}
+
+/* 
+    compute x s.t. g^x = h with DEC_THREAD_NUM threads (any number, 0 counts as 1): 
+    KANGAROO_GIVEN_UP indicates there is no such x in specified range, except with the probability above
+*/
+Kangaroo_Status Parallel_Kangaroo_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, size_t RANGE_LEN,
+                                       size_t TABLE_LEN, uint64_t DEC_THREAD_NUM)
+{
+    // check if the table is empty
+    if(dp2index_map.empty() == true)
+    {
+        cout << "the kangaroo table is empty" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t range_mask = Kangaroo_range_mask(RANGE_LEN);
+    if(DEC_THREAD_NUM == 0) DEC_THREAD_NUM = 1;
+    vector<uint64_t> x_index(DEC_THREAD_NUM);
+    vector<int> finding(DEC_THREAD_NUM, 0);
+    std::atomic<int> parallel_finding(0);
+    std::atomic<uint64_t> walk_count(0);
+
+    vector<thread> walk_task;
+    for(auto i = 0; i < DEC_THREAD_NUM; i++){
+        walk_task.push_back(std::thread(Kangaroo_wild_walk, std::ref(g), std::ref(h), std::ref(range_mask),
+                            std::ref(x_index[i]), std::ref(finding[i]), std::ref(parallel_finding),
+                            std::ref(walk_count)));
+    }
+    for(auto i = 0; i < DEC_THREAD_NUM; i++){
+        walk_task[i].join();
+    }
+
+    for(auto i = 0; i < DEC_THREAD_NUM; i++)
+    {
+        if(finding[i] == 1)
+        {
+            BN_set_word(x, x_index[i]);
+            return KANGAROO_FOUND;
+        }
+    }
+    cout << "the DLOG is not found in the specified range after " << KANGAROO_MAX_RETRY << " walks" << endl;
+    return KANGAROO_GIVEN_UP;
+}
+
+/* single thread version */
+Kangaroo_Status Kangaroo_DLOG(BIGNUM *&x, EC_POINT *&g, EC_POINT *&h, size_t RANGE_LEN, size_t TABLE_LEN)
+{
+    return Parallel_Kangaroo_DLOG(x, g, h, RANGE_LEN, TABLE_LEN, 1);
+}
+
+/*
+    choose the DLOG algorithm for RANGE_LEN under a memory budget (in bytes, 0 means no budget):
+    Shanks if its hash map fits into the budget, otherwise kangaroo with the largest table that fits.
+    The kangaroo table is capped at 2^{RANGE_LEN/3} entries, beyond which table generation dominates.
+*/
+int DLOG_Select_Method(size_t RANGE_LEN, size_t TUNNING, uint64_t MEMORY_BUDGET, size_t &TABLE_LEN)
+{
+    TABLE_LEN = 0;
+    uint64_t slot_num; 
+    uint64_t shanks_memory = HASHMAP_region_len(uint64_t(pow(2, RANGE_LEN/2 + TUNNING)), slot_num);
+    if(MEMORY_BUDGET == 0 || shanks_memory <= MEMORY_BUDGET) return DLOG_SHANKS;
+
+    while(TABLE_LEN < RANGE_LEN/3 && (KANGAROO_ENTRY_LEN << (TABLE_LEN+1)) <= MEMORY_BUDGET) TABLE_LEN++;
+    return DLOG_KANGAROO;
+}
+
+#endif
@@ -189,11 +189,8 @@ void Twisted_ElGamal_Initialize(Twisted_ElGamal_PP &pp)
 {
     cout << "Initialize Twisted ElGamal >>>" << endl; 
     /* generate or load the point2index.table */
-    if(!FILE_exist(hashmap_file))
-    {
-        // generate and serialize the point_2_index table
-        Parallel_HASHMAP_serialize(pp.h, hashmap_file, pp.MSG_LEN, pp.TUNNING, pp.IO_THREAD_NUM); 
-    }
+    // generate and serialize the point_2_index table, or extend a table built with a smaller TUNNING
+    Parallel_HASHMAP_grow(pp.h, hashmap_file, pp.MSG_LEN, pp.TUNNING, pp.IO_THREAD_NUM); 
     // load the table from file 
     HASHMAP_deserialize(hashmap_file, pp.MSG_LEN, pp.TUNNING);            
 }
@@ -406,7 +403,7 @@ void Twisted_ElGamal_Parallel_Dec(Twisted_ElGamal_PP &pp, BIGNUM *&sk, Twisted_E
     EC_POINT_invert(group, M, bn_ctx);          // M = -g^r
     EC_POINT_add(group, M, CT.Y, M, bn_ctx);    // M = h^m
 
-    bool success = Parallel_Shanks_DLOG(m, pp.h, M, pp.MSG_LEN, pp.TUNNING, pp.DEC_THREAD_NUM); // use Shanks's algorithm to decrypt
+    bool success = (Parallel_Shanks_DLOG(m, pp.h, M, pp.MSG_LEN, pp.TUNNING, pp.DEC_THREAD_NUM) == DLOG_FOUND); // use Shanks's algorithm to decrypt
   
     BN_free(sk_inverse); 
     EC_POINT_free(M);
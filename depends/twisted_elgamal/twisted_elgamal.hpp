@@ -14,8 +14,17 @@ this hpp implements twisted ElGamal encrypt scheme
 #include "../common/routines.hpp"
 
 #include "calculate_dlog.hpp"
+#include "kangaroo_dlog.hpp"
+#include "dlog_tuning.hpp"
+#include <future>
 
 const string hashmap_file  = "point2index.table"; // name of hashmap file
+const string kangaroo_file = "kangaroo.table"; // name of kangaroo table file
+const string dlog_profile_file = "dlog.profile"; // name of the calibrated DLOG profile
+
+const uint64_t DLOG_WAIT_FOREVER = UINT64_MAX; // decryptions never use a partial table
+
+std::shared_future<void> dlog_table_ready; // valid after Twisted_ElGamal_Initialize_Async
 
 // define the structure of PP
 struct Twisted_ElGamal_PP
@@ -25,6 +34,11 @@ struct Twisted_ElGamal_PP
     size_t TUNNING; //increase this parameter in [0, RANGE_LEN/2]: larger table leads to less running time
     size_t IO_THREAD_NUM; // optimized number of threads for faster building hash map 
     size_t DEC_THREAD_NUM; // optimized number of threads for faster decryption: CPU dependent
+    int DLOG_METHOD; // DLOG_SHANKS or DLOG_KANGAROO: chosen by MSG_LEN and the memory budget
+    size_t KANGAROO_TABLE_LEN; // the kangaroo table keeps 2^KANGAROO_TABLE_LEN distinguished points
+    string DLOG_SHM_NAME; // non-empty: share the Shanks table among processes via this shared-memory segment
+    bool DLOG_SHM_HUGEPAGE; // back the shared table with transparent huge pages
+    uint64_t DEC_WARMUP_WAIT; // ms a decryption waits for a table still loading before it searches the loaded part
 
     EC_POINT *g; 
     EC_POINT *h; // two random generators 
@@ -110,6 +124,9 @@ void Twisted_ElGamal_PP_print(Twisted_ElGamal_PP &pp)
 {
     cout << "the length of message space = " << pp.MSG_LEN << endl; 
     cout << "the tunning parameter for fast decryption = " << pp.TUNNING << endl;
+    if(pp.DLOG_METHOD == DLOG_KANGAROO){
+        cout << "decryption uses kangaroo with table size = 2^" << pp.KANGAROO_TABLE_LEN << endl;
+    }
     ECP_print(pp.g, "pp.g"); 
     ECP_print(pp.h, "pp.h"); 
 } 
@@ -159,14 +176,20 @@ void MR_Twisted_ElGamal_CT_deserialize(MR_Twisted_ElGamal_CT &CT, ifstream& fin)
     ECP_deserialize(CT.Y, fin); 
 }
 
-/* Setup algorithm */ 
+/* Setup algorithm: MEMORY_BUDGET (bytes) bounds the RAM of the DLOG table, 0 means no bound */ 
 void Twisted_ElGamal_Setup(Twisted_ElGamal_PP &pp, size_t MSG_LEN, size_t TUNNING, 
-                           size_t IO_THREAD_NUM, size_t DEC_THREAD_NUM)
+                           size_t IO_THREAD_NUM, size_t DEC_THREAD_NUM, uint64_t MEMORY_BUDGET = 0)
 { 
     pp.MSG_LEN = MSG_LEN; 
     pp.TUNNING = TUNNING; 
     pp.IO_THREAD_NUM = IO_THREAD_NUM;
     pp.DEC_THREAD_NUM = DEC_THREAD_NUM;  
+    /* use Shanks if its table fits into the memory budget, otherwise use kangaroo */
+    pp.DLOG_METHOD = DLOG_Select_Method(MSG_LEN, TUNNING, MEMORY_BUDGET, pp.KANGAROO_TABLE_LEN); 
+    /* each process keeps a private table unless pp.DLOG_SHM_NAME is set before initialization */
+    pp.DLOG_SHM_NAME = ""; 
+    pp.DLOG_SHM_HUGEPAGE = false; 
+    pp.DEC_WARMUP_WAIT = DLOG_WAIT_FOREVER; 
     /* set the message space to 2^{MSG_LEN} */
     BN_set_word(pp.BN_MSG_SIZE, uint64_t(pow(2, pp.MSG_LEN))); 
 
@@ -185,17 +208,108 @@ void Twisted_ElGamal_Setup(Twisted_ElGamal_PP &pp, size_t MSG_LEN, size_t TUNNIN
     //endif
 }
 
-void Twisted_ElGamal_Initialize(Twisted_ElGamal_PP &pp)
+/* 
+    Setup with TUNNING and thread numbers calibrated on this host under the RAM cap MEMORY_BUDGET (0: available RAM): 
+    the profile is loaded from profile_file if it was made for the same MSG_LEN, cap and core number 
+    (without a cap: for at most the share of RAM available now), otherwise it is measured and saved
+*/
+void Twisted_ElGamal_Setup_Auto(Twisted_ElGamal_PP &pp, size_t MSG_LEN, uint64_t MEMORY_BUDGET = 0, 
+                                string profile_file = dlog_profile_file)
+{
+    DLOG_Profile profile; 
+    if(DLOG_Profile_deserialize(profile, profile_file) == false || profile.RANGE_LEN != MSG_LEN 
+       || profile.CORE_NUM != max<size_t>(thread::hardware_concurrency(), 1) 
+       || (MEMORY_BUDGET != 0 && profile.MEMORY_BUDGET != MEMORY_BUDGET)
+       || (MEMORY_BUDGET == 0 && uint64_t(DLOG_available_memory() * DLOG_MEMORY_SHARE) < profile.MEMORY_BUDGET))
+    {
+        DLOG_Calibrate(profile, MSG_LEN, MEMORY_BUDGET); 
+        DLOG_Profile_serialize(profile, profile_file); 
+    }
+    DLOG_Profile_print(profile); 
+    Twisted_ElGamal_Setup(pp, MSG_LEN, profile.TUNNING, profile.IO_THREAD_NUM, profile.DEC_THREAD_NUM, 
+                          profile.MEMORY_BUDGET); 
+}
+
+/* generate or load the point2index.table into the table that has been bound (private or own shared segment) */
+void Twisted_ElGamal_Load_Table(Twisted_ElGamal_PP &pp)
+{
+    // generate and serialize the point_2_index table, or extend a table built with a smaller TUNNING
+    Parallel_HASHMAP_grow(pp.h, hashmap_file, pp.MSG_LEN, pp.TUNNING, pp.IO_THREAD_NUM); 
+    cout << "begin to load the hash map >>>" << endl; 
+    HASHMAP_load(hashmap_file); 
+}
+
+/* 
+    start the initialization and return at once: the DLOG table is built or loaded by a background thread, 
+    the returned future is ready once the table is complete (pp must stay alive until then)
+    Shanks decryptions during warm-up wait up to pp.DEC_WARMUP_WAIT ms and then search the loaded part, 
+    kangaroo decryptions wait for the table
+*/
+std::shared_future<void> Twisted_ElGamal_Initialize_Async(Twisted_ElGamal_PP &pp)
 {
     cout << "Initialize Twisted ElGamal >>>" << endl; 
-    /* generate or load the point2index.table */
-    if(!FILE_exist(hashmap_file))
+    if(pp.DLOG_METHOD == DLOG_KANGAROO)
+    {
+        /* generate or load the kangaroo.table */
+        dlog_table_ready = std::async(std::launch::async, [&pp]{
+            if(!FILE_exist(kangaroo_file))
+            {
+                Kangaroo_Table_serialize(pp.h, kangaroo_file, pp.MSG_LEN, pp.KANGAROO_TABLE_LEN, pp.IO_THREAD_NUM); 
+            }
+            else{
+                Kangaroo_Table_deserialize(pp.h, kangaroo_file, pp.MSG_LEN, pp.KANGAROO_TABLE_LEN); 
+            }
+        }).share(); 
+        return dlog_table_ready; 
+    }
+
+    /* bind the table now, so that decryptions can search whatever has been loaded */
+    if(!pp.DLOG_SHM_NAME.empty() && HASHMAP_attach(pp.h, pp.DLOG_SHM_NAME, pp.MSG_LEN, pp.TUNNING))
+    {
+        // another process is the publisher: wait until it completes the segment
+        dlog_table_ready = std::async(std::launch::async, []{
+            if(HASHMAP_wait(HASHMAP_ATTACH_TIMEOUT*1000) == false)
+            {
+                cout << "shared hash map is incomplete: remove it with HASHMAP_unlink and retry" << endl; 
+                exit(EXIT_FAILURE); 
+            }
+        }).share(); 
+        return dlog_table_ready; 
+    }
+    if(pp.DLOG_SHM_NAME.empty()){
+        HASHMAP_reserve(pp.MSG_LEN, pp.TUNNING); 
+    }
+    else if(HASHMAP_create(pp.DLOG_SHM_NAME, pp.MSG_LEN, pp.TUNNING, pp.DLOG_SHM_HUGEPAGE) == false)
+    {
+        // lost the race to another publisher
+        return Twisted_ElGamal_Initialize_Async(pp); 
+    }
+    dlog_table_ready = std::async(std::launch::async, Twisted_ElGamal_Load_Table, std::ref(pp)).share(); 
+    return dlog_table_ready; 
+}
+
+/* initialize and wait until the DLOG table is complete */
+void Twisted_ElGamal_Initialize(Twisted_ElGamal_PP &pp)
+{
+    Twisted_ElGamal_Initialize_Async(pp).wait(); 
+}
+
+/* 
+    called by decryption: return at once if the table is complete; 
+    otherwise wait up to pp.DEC_WARMUP_WAIT ms, then go on with the loaded part of the Shanks table 
+*/
+void Twisted_ElGamal_Warmup(Twisted_ElGamal_PP &pp)
+{
+    if(dlog_table_ready.valid() == false) return; 
+    if(pp.DLOG_METHOD == DLOG_KANGAROO || pp.DEC_WARMUP_WAIT == DLOG_WAIT_FOREVER)
     {
-        // generate and serialize the point_2_index table
-        Parallel_HASHMAP_serialize(pp.h, hashmap_file, pp.MSG_LEN, pp.TUNNING, pp.IO_THREAD_NUM); 
+        dlog_table_ready.wait(); 
+        return; 
     }
-    // load the table from file 
-    HASHMAP_deserialize(hashmap_file, pp.MSG_LEN, pp.TUNNING);            
+    if(dlog_table_ready.wait_for(chrono::milliseconds(pp.DEC_WARMUP_WAIT)) == std::future_status::ready) return; 
+    // the degraded search needs at least one loaded block: an attached segment has one already, 
+    // a table loaded by this process signals its blocks
+    HASHMAP_wait_loaded(); 
 }
 
 /* KeyGen algorithm */ 
@@ -249,11 +363,12 @@ void Twisted_ElGamal_Enc(Twisted_ElGamal_PP &pp,
     #endif
 }
 
-/* Decryption algorithm: compute m = Dec(sk, CT) */ 
+/* Decryption algorithm: compute m = Dec(sk, CT), the Shanks search starts at the expected value hint */ 
 void Twisted_ElGamal_Dec(Twisted_ElGamal_PP &pp, 
                          BIGNUM* &sk, 
                          Twisted_ElGamal_CT &CT, 
-                         BIGNUM* &m)
+                         BIGNUM* &m, 
+                         uint64_t hint = 0)
 { 
     //begin decryption  
     BIGNUM *sk_inverse = BN_new(); 
@@ -264,8 +379,16 @@ void Twisted_ElGamal_Dec(Twisted_ElGamal_PP &pp,
     EC_POINT_invert(group, M, bn_ctx);          // M = -g^r
     EC_POINT_add(group, M, CT.Y, M, bn_ctx);    // M = h^m
 
+    Twisted_ElGamal_Warmup(pp); 
     //Brute_Search(m, pp.h, M); 
-    bool success = Shanks_DLOG(m, pp.h, M, pp.MSG_LEN, pp.TUNNING); // use Shanks's algorithm to decrypt
+    bool success; 
+    if(pp.DLOG_METHOD == DLOG_KANGAROO){
+        // use kangaroo to decrypt: giving up on an in-range message is bounded in kangaroo_dlog.hpp
+        success = (Kangaroo_DLOG(m, pp.h, M, pp.MSG_LEN, pp.KANGAROO_TABLE_LEN) == KANGAROO_FOUND);
+    }
+    else{
+        success = Shanks_DLOG(m, pp.h, M, pp.MSG_LEN, pp.TUNNING, hint); // use Shanks's algorithm to decrypt
+    }
   
     BN_free(sk_inverse); 
     EC_POINT_free(M);
@@ -276,6 +399,44 @@ void Twisted_ElGamal_Dec(Twisted_ElGamal_PP &pp,
     }  
 }
 
+/* Batch decryption algorithm: compute m[k] = Dec(sk, CT[k]) for a batch of ciphertexts under the same key
+   finding[k] = 0 indicates that m[k] is not in the message space, the batch is not aborted 
+   vec_hint optionally gives the expected value of each m[k] */ 
+void Twisted_ElGamal_Batch_Dec(Twisted_ElGamal_PP &pp, 
+                               BIGNUM* &sk, 
+                               vector<Twisted_ElGamal_CT> &vec_CT, 
+                               vector<BIGNUM *> &vec_m, 
+                               vector<int> &vec_finding, 
+                               const vector<uint64_t> &vec_hint = vector<uint64_t>())
+{ 
+    BIGNUM *sk_inverse = BN_new(); 
+    BN_mod_inverse(sk_inverse, sk, order, bn_ctx);  // compute the inverse of sk in Z_q^* 
+
+    vector<EC_POINT *> vec_M(vec_CT.size()); 
+    ECP_vec_new(vec_M); 
+    for(auto k = 0; k < vec_CT.size(); k++)
+    {
+        EC_POINT_mul(group, vec_M[k], NULL, vec_CT[k].X, sk_inverse, bn_ctx); // M = X^{sk^{-1}} = g^r 
+        EC_POINT_invert(group, vec_M[k], bn_ctx);                 // M = -g^r
+        EC_POINT_add(group, vec_M[k], vec_CT[k].Y, vec_M[k], bn_ctx); // M = h^m
+    }
+
+    Twisted_ElGamal_Warmup(pp); 
+    if(pp.DLOG_METHOD == DLOG_KANGAROO)
+    {
+        vec_finding.resize(vec_M.size()); 
+        for(auto k = 0; k < vec_M.size(); k++){
+            vec_finding[k] = (Kangaroo_DLOG(vec_m[k], pp.h, vec_M[k], pp.MSG_LEN, pp.KANGAROO_TABLE_LEN) == KANGAROO_FOUND); 
+        }
+    }
+    else{
+        Shanks_DLOG_Batch(vec_m, pp.h, vec_M, pp.MSG_LEN, pp.TUNNING, vec_finding, vec_hint); // walk all the targets in lockstep
+    }
+
+    BN_free(sk_inverse); 
+    ECP_vec_free(vec_M); 
+}
+
 /* rerandomize ciphertext CT with given randomness r */ 
 void Twisted_ElGamal_ReRand(Twisted_ElGamal_PP &pp, 
                              EC_POINT* &pk, 
@@ -394,8 +555,9 @@ void Twisted_ElGamal_Parallel_Enc(Twisted_ElGamal_PP &pp, EC_POINT *&pk, BIGNUM
 }
 
 
-/* Decryption algorithm: compute m = Dec(sk, CT) */
-void Twisted_ElGamal_Parallel_Dec(Twisted_ElGamal_PP &pp, BIGNUM *&sk, Twisted_ElGamal_CT &CT, BIGNUM *&m)
+/* Decryption algorithm: compute m = Dec(sk, CT), the Shanks search starts at the expected value hint */
+void Twisted_ElGamal_Parallel_Dec(Twisted_ElGamal_PP &pp, BIGNUM *&sk, Twisted_ElGamal_CT &CT, BIGNUM *&m, 
+                                  uint64_t hint = 0)
 { 
     /* begin to decrypt */  
     BIGNUM *sk_inverse = BN_new(); 
@@ -406,7 +568,15 @@ void Twisted_ElGamal_Parallel_Dec(Twisted_ElGamal_PP &pp, BIGNUM *&sk, Twisted_E
     EC_POINT_invert(group, M, bn_ctx);          // M = -g^r
     EC_POINT_add(group, M, CT.Y, M, bn_ctx);    // M = h^m
 
-    bool success = Parallel_Shanks_DLOG(m, pp.h, M, pp.MSG_LEN, pp.TUNNING, pp.DEC_THREAD_NUM); // use Shanks's algorithm to decrypt
+    Twisted_ElGamal_Warmup(pp); 
+    bool success; 
+    if(pp.DLOG_METHOD == DLOG_KANGAROO){
+        success = (Parallel_Kangaroo_DLOG(m, pp.h, M, pp.MSG_LEN, pp.KANGAROO_TABLE_LEN, pp.DEC_THREAD_NUM) == KANGAROO_FOUND); 
+    }
+    else{
+        success = (Parallel_Shanks_DLOG(m, pp.h, M, pp.MSG_LEN, pp.TUNNING, pp.DEC_THREAD_NUM, 
+                                        NULL, hint) == DLOG_FOUND); // use Shanks's algorithm to decrypt
+    }
   
     BN_free(sk_inverse); 
     EC_POINT_free(M);
@@ -418,6 +588,40 @@ void Twisted_ElGamal_Parallel_Dec(Twisted_ElGamal_PP &pp, BIGNUM *&sk, Twisted_E
     }  
 }
 
+/* Parallel batch decryption algorithm: compute m[k] = Dec(sk, CT[k]), vec_hint as in Twisted_ElGamal_Batch_Dec */
+void Twisted_ElGamal_Parallel_Batch_Dec(Twisted_ElGamal_PP &pp, BIGNUM *&sk, vector<Twisted_ElGamal_CT> &vec_CT, 
+                                        vector<BIGNUM *> &vec_m, vector<int> &vec_finding, 
+                                        const vector<uint64_t> &vec_hint = vector<uint64_t>())
+{ 
+    BIGNUM *sk_inverse = BN_new(); 
+    BN_mod_inverse(sk_inverse, sk, order, bn_ctx);  // compute the inverse of sk in Z_p^* 
+
+    vector<EC_POINT *> vec_M(vec_CT.size()); 
+    ECP_vec_new(vec_M); 
+    for(auto k = 0; k < vec_CT.size(); k++)
+    {
+        EC_POINT_mul(group, vec_M[k], NULL, vec_CT[k].X, sk_inverse, bn_ctx); // M = X^{sk^{-1}} = g^r 
+        EC_POINT_invert(group, vec_M[k], bn_ctx);                 // M = -g^r
+        EC_POINT_add(group, vec_M[k], vec_CT[k].Y, vec_M[k], bn_ctx); // M = h^m
+    }
+
+    Twisted_ElGamal_Warmup(pp); 
+    if(pp.DLOG_METHOD == DLOG_KANGAROO)
+    {
+        vec_finding.resize(vec_M.size()); 
+        for(auto k = 0; k < vec_M.size(); k++){
+            vec_finding[k] = (Parallel_Kangaroo_DLOG(vec_m[k], pp.h, vec_M[k], pp.MSG_LEN, 
+                                                     pp.KANGAROO_TABLE_LEN, pp.DEC_THREAD_NUM) == KANGAROO_FOUND); 
+        }
+    }
+    else{
+        Parallel_Shanks_DLOG_Batch(vec_m, pp.h, vec_M, pp.MSG_LEN, pp.TUNNING, pp.DEC_THREAD_NUM, vec_finding, vec_hint); 
+    }
+
+    BN_free(sk_inverse); 
+    ECP_vec_free(vec_M); 
+}
+
 // parallel re-randomization
 void Twisted_ElGamal_Parallel_ReRand(Twisted_ElGamal_PP &pp, EC_POINT *&pk, BIGNUM *&sk, 
                             Twisted_ElGamal_CT &CT, Twisted_ElGamal_CT &CT_new, BIGNUM *&r)
@@ -0,0 +1,150 @@
+#include "../depends/common/global.hpp"
+#include "../depends/common/print.hpp"
+#include "../depends/common/routines.hpp"
+#include "../depends/twisted_elgamal/twisted_elgamal.hpp"
+#include "../depends/sigma/sigma_proof.hpp"
+#include "../depends/bulletproofs/bit_proof.hpp"
+#include <vector>
+using namespace std;
+
+/*
+    benchmark of proving that N twisted ElGamal ciphertexts encrypt bits:
+    N Sigma OR-proofs (Sigma_Prove_Zero/One, Sigma_Verify) vs. one aggregated proof (Bit_Prove, Bit_Verify)
+    for N = 64, 256, ..., MAX_BIT_NUM, with the time of all N and the proof size in points and scalars
+    usage: bench_bit_proof [MAX_BIT_NUM] [THREAD_NUM], THREAD_NUM applies to the aggregated proof (default 1,
+    the Sigma proofs run on one thread)
+*/
+
+const size_t MAX_BIT_NUM = 65536;
+
+double elapsed_ms(chrono::steady_clock::time_point start_time)
+{
+    return chrono::duration <double, milli> (chrono::steady_clock::now() - start_time).count();
+}
+
+int main(int argc, char *argv[])
+{
+    // curve id = NID_secp256k1
+    global_initialize(NID_secp256k1);
+
+    size_t max_bit_num = MAX_BIT_NUM;
+    if(argc > 1) max_bit_num = atoi(argv[1]);
+    size_t THREAD_NUM = 1;
+    if(argc > 2) THREAD_NUM = atoi(argv[2]);
+
+    Twisted_ElGamal_PP pp_tt;
+    Twisted_ElGamal_PP_new(pp_tt);
+    size_t MSG_LEN = 32;
+    size_t TUNNING = 7;
+    size_t IO_THREAD_NUM = 4;
+    size_t DEC_THREAD_NUM = 4;
+    Twisted_ElGamal_Setup(pp_tt, MSG_LEN, TUNNING, IO_THREAD_NUM, DEC_THREAD_NUM);
+
+    Twisted_ElGamal_KP keypair;
+    Twisted_ElGamal_KP_new(keypair);
+    Twisted_ElGamal_KeyGen(pp_tt, keypair);
+
+    Sigma_PP sigma_pp;
+    Sigma_PP_new(sigma_pp);
+    Sigma_Setup(sigma_pp, pp_tt.h);
+
+    SplitLine_print('-');
+    cout << "bit proofs for N twisted ElGamal ciphertexts, aggregated proof on " << THREAD_NUM << " threads" << endl;
+    cout << "N\tSigma prove\tSigma verify\tSigma size\tBit prove\tBit verify\tBit size\t(ms for all N; points+scalars)" << endl;
+
+    for(size_t BIT_NUM = 64; BIT_NUM <= max_bit_num; BIT_NUM *= 4)
+    {
+        vector<Twisted_ElGamal_CT> vec_CT(BIT_NUM);
+        vector<BIGNUM *> vec_r(BIT_NUM), vec_m(BIT_NUM);
+        BN_vec_new(vec_r);
+        BN_vec_new(vec_m);
+        for(auto j = 0; j < BIT_NUM; j++)
+        {
+            Twisted_ElGamal_CT_new(vec_CT[j]);
+            BN_random(vec_r[j]);
+            BN_rand(vec_m[j], 1, BN_RAND_TOP_ANY, BN_RAND_BOTTOM_ANY);
+            Twisted_ElGamal_Enc(pp_tt, keypair.pk, vec_m[j], vec_r[j], vec_CT[j]);
+        }
+
+        // N Sigma OR-proofs
+        vector<Sigma_Instance> vec_instance(BIT_NUM);
+        vector<Sigma_Proof> vec_sigma_proof(BIT_NUM);
+        Sigma_Witness sigma_witness;
+        Sigma_Witness_new(sigma_witness);
+        for(auto j = 0; j < BIT_NUM; j++)
+        {
+            Sigma_Instance_new(vec_instance[j]);
+            Sigma_Proof_new(vec_sigma_proof[j]);
+            EC_POINT_copy(vec_instance[j].twisted_ek, keypair.pk);
+            EC_POINT_copy(vec_instance[j].U, vec_CT[j].Y);
+            EC_POINT_copy(vec_instance[j].V, vec_CT[j].X);
+        }
+
+        auto start_time = chrono::steady_clock::now();
+        for(auto j = 0; j < BIT_NUM; j++)
+        {
+            string transcript_str = "";
+            BN_copy(sigma_witness.r, vec_r[j]);
+            if(BN_is_zero(vec_m[j])) Sigma_Prove_Zero(sigma_pp, vec_instance[j], sigma_witness, transcript_str, vec_sigma_proof[j]);
+            else Sigma_Prove_One(sigma_pp, vec_instance[j], sigma_witness, transcript_str, vec_sigma_proof[j]);
+        }
+        double sigma_prove_time = elapsed_ms(start_time);
+
+        start_time = chrono::steady_clock::now();
+        bool sigma_validity = true;
+        for(auto j = 0; j < BIT_NUM; j++)
+        {
+            string transcript_str = "";
+            sigma_validity &= Sigma_Verify(sigma_pp, vec_instance[j], transcript_str, vec_sigma_proof[j]);
+        }
+        double sigma_verify_time = elapsed_ms(start_time);
+
+        // one aggregated proof
+        Bullet_PP bit_pp;
+        Bit_PP_new(bit_pp, BIT_NUM);
+        Bit_Setup(bit_pp, pp_tt, BIT_NUM);
+        Bullet_Proof bit_proof;
+        Bullet_Proof_new(bit_proof);
+
+        start_time = chrono::steady_clock::now();
+        string transcript_str = "";
+        Bit_Prove(bit_pp, vec_CT, vec_r, vec_m, transcript_str, bit_proof, THREAD_NUM);
+        double bit_prove_time = elapsed_ms(start_time);
+
+        start_time = chrono::steady_clock::now();
+        transcript_str = "";
+        bool bit_validity = Bit_Verify(bit_pp, vec_CT, transcript_str, bit_proof, bn_ctx, THREAD_NUM);
+        double bit_verify_time = elapsed_ms(start_time);
+
+        if(sigma_validity == false || bit_validity == false)
+        {
+            cout << "the proofs for N = " << BIT_NUM << " are rejected" << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        cout << BIT_NUM << "\t" << sigma_prove_time << "\t" << sigma_verify_time << "\t"
+             << 4*BIT_NUM << "+" << 4*BIT_NUM << "\t"
+             << bit_prove_time << "\t" << bit_verify_time << "\t"
+             << 4 + 2*bit_proof.ip_proof.vec_L.size() << "+" << 5 << endl;
+
+        for(auto j = 0; j < BIT_NUM; j++)
+        {
+            Twisted_ElGamal_CT_free(vec_CT[j]);
+            Sigma_Instance_free(vec_instance[j]);
+            Sigma_Proof_free(vec_sigma_proof[j]);
+        }
+        BN_vec_free(vec_r);
+        BN_vec_free(vec_m);
+        Sigma_Witness_free(sigma_witness);
+        Bullet_PP_free(bit_pp);
+        Bullet_Proof_free(bit_proof);
+    }
+
+    Twisted_ElGamal_PP_free(pp_tt);
+    Twisted_ElGamal_KP_free(keypair);
+    Sigma_PP_free(sigma_pp);
+
+    global_finalize();
+
+    return 0;
+}
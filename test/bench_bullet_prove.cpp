@@ -0,0 +1,103 @@
+#include "../depends/common/global.hpp"
+#include "../depends/common/print.hpp"
+#include "../depends/common/routines.hpp"
+#include "../depends/bulletproofs/aggregate_bulletproof.hpp"
+#include <vector>
+using namespace std;
+
+/*
+    benchmark of the aggregated Bulletproof prover: prove time vs. the number of threads
+    for RANGE_LEN = 64 and AGG_NUM = 1, 2, 4, ..., MAX_AGG_NUM
+    the thread counts are 1, 2, 4, ... up to the number of cores (and the number of cores itself)
+    usage: bench_bullet_prove [MAX_AGG_NUM] [WINDOW_LEN], WINDOW_LEN > 0 precomputes fixed-base tables
+*/
+
+const size_t RANGE_LEN = 64;
+const size_t MAX_AGG_NUM = 64;
+
+/* average time in ms of one proof, over at least MIN_TIME ms */
+const double MIN_TIME = 1000;
+
+double bench_prove(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witness, size_t THREAD_NUM)
+{
+    size_t round = 0;
+    auto start_time = chrono::steady_clock::now();
+    double prove_time = 0;
+    while(prove_time < MIN_TIME)
+    {
+        Bullet_Proof proof;
+        Bullet_Proof_new(proof);
+        string transcript_str = "";
+        Bullet_Prove(pp, instance, witness, transcript_str, proof, THREAD_NUM);
+        round++;
+        prove_time = chrono::duration <double, milli> (chrono::steady_clock::now() - start_time).count();
+
+        // check the first proof of every setting
+        transcript_str = "";
+        if(round == 1 && Bullet_Verify(pp, instance, transcript_str, proof) == false)
+        {
+            cout << "the proof for AGG_NUM = " << pp.AGG_NUM << " with " << THREAD_NUM << " threads is rejected" << endl;
+            exit(EXIT_FAILURE);
+        }
+        Bullet_Proof_free(proof);
+    }
+    return prove_time/round;
+}
+
+int main(int argc, char *argv[])
+{
+    // curve id = NID_secp256k1
+    global_initialize(NID_secp256k1);
+
+    size_t max_agg_num = MAX_AGG_NUM;
+    if(argc > 1) max_agg_num = atoi(argv[1]);
+    size_t window_len = 0;
+    if(argc > 2) window_len = atoi(argv[2]);
+    size_t CORE_NUM = max<size_t>(thread::hardware_concurrency(), 1);
+    vector<size_t> vec_thread_num;
+    for(size_t THREAD_NUM = 1; THREAD_NUM < CORE_NUM; THREAD_NUM *= 2) vec_thread_num.push_back(THREAD_NUM);
+    vec_thread_num.push_back(CORE_NUM);
+
+    SplitLine_print('-');
+    cout << "aggregated Bulletproof prover, RANGE_LEN = " << RANGE_LEN << ", " << CORE_NUM << " cores";
+    if(window_len > 0) cout << ", fixed-base tables with WINDOW_LEN = " << window_len;
+    cout << endl;
+    cout << "AGG_NUM";
+    for(auto THREAD_NUM : vec_thread_num) cout << "\t" << THREAD_NUM << " threads";
+    cout << "\t(ms per proof)" << endl;
+
+    for(size_t AGG_NUM = 1; AGG_NUM <= max_agg_num; AGG_NUM *= 2)
+    {
+        size_t range_len = RANGE_LEN, agg_num = AGG_NUM;
+        Bullet_PP pp;
+        Bullet_PP_new(pp, range_len, agg_num);
+        Bullet_Setup(pp, range_len, agg_num);
+        if(window_len > 0) Bullet_PP_precompute(pp, window_len);
+
+        Bullet_Instance instance;
+        Bullet_Instance_new(pp, instance);
+        Bullet_Witness witness;
+        Bullet_Witness_new(pp, witness);
+        for(auto i = 0; i < AGG_NUM; i++)
+        {
+            BN_random(witness.r[i]);
+            BN_rand(witness.v[i], RANGE_LEN, BN_RAND_TOP_ANY, BN_RAND_BOTTOM_ANY);
+        }
+        Bullet_Commit(pp, instance, witness);
+
+        cout << AGG_NUM;
+        for(auto THREAD_NUM : vec_thread_num)
+        {
+            cout << "\t" << bench_prove(pp, instance, witness, THREAD_NUM) << flush;
+        }
+        cout << endl;
+
+        Bullet_PP_free(pp);
+        Bullet_Instance_free(instance);
+        Bullet_Witness_free(witness);
+    }
+
+    global_finalize();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "../depends/twisted_elgamal/twisted_elgamal.hpp"
+#include <string.h>
+#include <vector>
+using namespace std;
+
+/*
+    microbenchmark of the DLOG hash table probes: one HASHMAP_find per key vs. HASHMAP_probe_batch
+    over tables of 2^16, ..., 2^MAX_LOG_ENTRY_NUM random entries, probing for absent keys (the common case
+    of a giant step) mixed with present keys
+*/
+
+const size_t PROBE_NUM = 1 << 20;
+const size_t MAX_LOG_ENTRY_NUM = 24;
+const string probe_file = "bench_probe.table";
+
+void random_keys(vector<unsigned char> &keys, size_t n, mt19937_64 &prng)
+{
+    keys.resize(n*POINT_LEN);
+    for(auto k = 0; k < n*POINT_LEN; k++) keys[k] = prng();
+    for(auto k = 0; k < n; k++) keys[k*POINT_LEN] = 2 + (keys[k*POINT_LEN] & 1); // parity byte of a compressed point
+}
+
+void bench_probe(size_t LOG_ENTRY_NUM)
+{
+    SplitLine_print('-');
+    uint64_t entry_num = uint64_t(1) << LOG_ENTRY_NUM;
+    mt19937_64 prng(LOG_ENTRY_NUM);
+
+    // fill a table with random keys through a table file
+    vector<unsigned char> keys;
+    random_keys(keys, entry_num, prng);
+    ofstream fout(probe_file, ios::binary);
+    fout.write(reinterpret_cast<char *>(keys.data()), keys.size());
+    fout.close();
+    HASHMAP_reserve(2*LOG_ENTRY_NUM, 0);
+    HASHMAP_load(probe_file);
+    remove(probe_file.c_str());
+
+    // one probe in 16 hits the table
+    vector<unsigned char> probe;
+    random_keys(probe, PROBE_NUM, prng);
+    for(auto k = 0; k < PROBE_NUM; k += 16){
+        memcpy(probe.data()+k*POINT_LEN, keys.data()+(prng()%entry_num)*POINT_LEN, POINT_LEN);
+    }
+
+    vector<uint64_t> vec_index(PROBE_NUM);
+    vector<int> vec_found(PROBE_NUM);
+
+    auto start_time = chrono::steady_clock::now();
+    size_t single_found = 0;
+    for(auto k = 0; k < PROBE_NUM; k++){
+        single_found += HASHMAP_find(probe.data()+k*POINT_LEN, vec_index[k], entry_num);
+    }
+    auto end_time = chrono::steady_clock::now();
+    double single_time = chrono::duration <double, nano> (end_time - start_time).count()/PROBE_NUM;
+
+    start_time = chrono::steady_clock::now();
+    size_t batch_found = HASHMAP_probe_batch(probe.data(), PROBE_NUM, vec_index.data(), vec_found.data(), entry_num);
+    end_time = chrono::steady_clock::now();
+    double batch_time = chrono::duration <double, nano> (end_time - start_time).count()/PROBE_NUM;
+
+    if(single_found != batch_found)
+    {
+        cout << "the batched probe disagrees with the single probe" << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "table size = 2^" << LOG_ENTRY_NUM << " entries ("
+         << point2index_table.region_len/(1024*1024) << " MB), " << batch_found << " hits" << endl;
+    cout << "single probe = " << single_time << " ns/key, batched probe = " << batch_time
+         << " ns/key, speedup = " << single_time/batch_time << endl;
+    HASHMAP_free();
+}
+
+int main(int argc, char *argv[])
+{
+    // curve id = NID_secp256k1
+    global_initialize(NID_secp256k1);
+
+    size_t max_log_entry_num = MAX_LOG_ENTRY_NUM;
+    if(argc > 1) max_log_entry_num = atoi(argv[1]);
+    for(size_t LOG_ENTRY_NUM = 16; LOG_ENTRY_NUM <= max_log_entry_num; LOG_ENTRY_NUM += 2){
+        bench_probe(LOG_ENTRY_NUM);
+    }
+
+    global_finalize();
+
+    return 0;
+}
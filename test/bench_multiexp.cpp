@@ -0,0 +1,84 @@
+#include "../depends/common/global.hpp"
+#include "../depends/common/print.hpp"
+#include "../depends/common/routines.hpp"
+#include "../depends/common/multiexp.hpp"
+#include <vector>
+using namespace std;
+
+/*
+    benchmark of multi-scalar multiplication: EC_POINTs_mul vs. ECP_multiexp (bucket method)
+    for 2, 4, ..., 2^MAX_LOG_LEN random terms
+*/
+
+const size_t MAX_LOG_LEN = 16;
+
+/* average time in ms of one call, over at least MIN_TIME ms */
+const double MIN_TIME = 200;
+
+void bench_multiexp(size_t LEN, vector<EC_POINT *> &vec_A_all, vector<BIGNUM *> &vec_a_all)
+{
+    vector<EC_POINT *> vec_A(vec_A_all.begin(), vec_A_all.begin() + LEN);
+    vector<BIGNUM *> vec_a(vec_a_all.begin(), vec_a_all.begin() + LEN);
+    EC_POINT *openssl_result = EC_POINT_new(group);
+    EC_POINT *multiexp_result = EC_POINT_new(group);
+
+    size_t openssl_round = 0;
+    auto start_time = chrono::steady_clock::now();
+    double openssl_time = 0;
+    while(openssl_time < MIN_TIME)
+    {
+        EC_POINTs_mul(group, openssl_result, NULL, LEN, (const EC_POINT**)vec_A.data(), (const BIGNUM**)vec_a.data(), bn_ctx);
+        openssl_round++;
+        openssl_time = chrono::duration <double, milli> (chrono::steady_clock::now() - start_time).count();
+    }
+
+    size_t multiexp_round = 0;
+    start_time = chrono::steady_clock::now();
+    double multiexp_time = 0;
+    while(multiexp_time < MIN_TIME)
+    {
+        ECP_multiexp(multiexp_result, vec_A, vec_a);
+        multiexp_round++;
+        multiexp_time = chrono::duration <double, milli> (chrono::steady_clock::now() - start_time).count();
+    }
+
+    if(EC_POINT_cmp(group, openssl_result, multiexp_result, bn_ctx) != 0)
+    {
+        cout << "ECP_multiexp disagrees with EC_POINTs_mul for " << LEN << " terms" << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "n = " << LEN << ": EC_POINTs_mul = " << openssl_time/openssl_round << " ms, ECP_multiexp = "
+         << multiexp_time/multiexp_round << " ms, speedup = "
+         << (openssl_time/openssl_round)/(multiexp_time/multiexp_round) << endl;
+
+    EC_POINT_free(openssl_result);
+    EC_POINT_free(multiexp_result);
+}
+
+int main(int argc, char *argv[])
+{
+    // curve id = NID_secp256k1
+    global_initialize(NID_secp256k1);
+
+    size_t max_log_len = MAX_LOG_LEN;
+    if(argc > 1) max_log_len = atoi(argv[1]);
+    SplitLine_print('-');
+    cout << "multi-scalar multiplication with " << thread::hardware_concurrency() << " threads" << endl;
+
+    vector<EC_POINT *> vec_A(size_t(1) << max_log_len);
+    ECP_vec_new(vec_A);
+    ECP_vec_random(vec_A);
+    vector<BIGNUM *> vec_a(size_t(1) << max_log_len);
+    BN_vec_new(vec_a);
+    BN_vec_random(vec_a);
+
+    for(size_t LOG_LEN = 1; LOG_LEN <= max_log_len; LOG_LEN++){
+        bench_multiexp(size_t(1) << LOG_LEN, vec_A, vec_a);
+    }
+
+    ECP_vec_free(vec_A);
+    BN_vec_free(vec_a);
+    global_finalize();
+
+    return 0;
+}
@@ -0,0 +1,470 @@
+#include "../depends/common/global.hpp"
+#include "../depends/common/routines.hpp"
+#include "../depends/bulletproofs/aggregate_bulletproof.hpp"
+#include "../depends/bulletproofs/bit_proof.hpp"
+#include <vector>
+using namespace std;
+
+/*
+    regression tests of the aggregated Bulletproofs: exits with EXIT_FAILURE if a check fails
+*/
+
+size_t FAIL_NUM = 0;
+
+void check(bool result, bool expected, string note)
+{
+    if(result == expected) return;
+    FAIL_NUM++;
+    cout << "FAIL: " << note << endl;
+}
+
+/* planting points with a known DLOG in a pp file (with a recomputed digest) makes the load fail and the cached setup re-derive */
+void test_pp_file(size_t RANGE_LEN, size_t AGG_NUM)
+{
+    string note = "pp file of " + to_string(RANGE_LEN) + "x" + to_string(AGG_NUM) + ": ";
+    string pp_file = "test_bulletproofs_" + to_string(getpid()) + ".pp";
+    Bullet_PP pp, pp_loaded;
+    Bullet_PP_new(pp, RANGE_LEN, AGG_NUM);
+    Bullet_PP_new(pp_loaded, RANGE_LEN, AGG_NUM);
+    Bullet_Setup(pp, RANGE_LEN, AGG_NUM);
+
+    Bullet_PP_serialize(pp, pp_file);
+    bool VALID = Bullet_PP_deserialize(pp_loaded, RANGE_LEN, AGG_NUM, pp_file);
+    for (auto i = 0; i < pp.vec_g.size() && VALID; i++)
+    {
+        VALID = EC_POINT_cmp(group, pp.vec_g[i], pp_loaded.vec_g[i], bn_ctx) == 0
+                && EC_POINT_cmp(group, pp.vec_h[i], pp_loaded.vec_h[i], bn_ctx) == 0;
+    }
+    check(VALID, true, note + "honest file");
+
+    BIGNUM *k = BN_new();
+    BN_random(k);
+    vector<EC_POINT *> vec_planted = {pp.g, pp.h, pp.u, pp.vec_g[0], pp.vec_h.back()};
+    vector<string> vec_name = {"g", "h", "u", "vec_g[0]", "vec_h[last]"};
+    EC_POINT *original = EC_POINT_new(group);
+    for (auto t = 0; t < vec_planted.size(); t++)
+    {
+        EC_POINT_copy(original, vec_planted[t]);
+        EC_POINT_mul(group, vec_planted[t], k, NULL, NULL, bn_ctx);
+        Bullet_PP_serialize(pp, pp_file);
+        EC_POINT_copy(vec_planted[t], original);
+        check(Bullet_PP_deserialize(pp_loaded, RANGE_LEN, AGG_NUM, pp_file), false, note + "planted " + vec_name[t]);
+    }
+
+    // the cached setup replaces the planted file with the derived pp
+    Bullet_Setup_Cached(pp_loaded, RANGE_LEN, AGG_NUM, pp_file);
+    check(EC_POINT_cmp(group, pp.vec_h.back(), pp_loaded.vec_h.back(), bn_ctx) == 0
+          && Bullet_PP_deserialize(pp_loaded, RANGE_LEN, AGG_NUM, pp_file), true, note + "re-derived file");
+
+    remove(pp_file.c_str());
+    EC_POINT_free(original);
+    BN_free(k);
+    Bullet_PP_free(pp);
+    Bullet_PP_free(pp_loaded);
+}
+
+/*
+    a prover for arbitrary aL, aR over all pp.vec_g.size() coordinates, for building forged proofs: sL, sR are
+    random on every coordinate, and A and S commit to the offsets from the public padding (aL = 0, aR = -1,
+    sL = sR = 0), so with aL = 0 and aR = -1 on the padding it makes valid proofs
+*/
+void Forge_Prove(Bullet_PP &pp, Bullet_Instance &instance, vector<BIGNUM *> &vec_r,
+                 vector<BIGNUM *> &vec_aL, vector<BIGNUM *> &vec_aR, string &transcript_str, Bullet_Proof &proof)
+{
+    size_t NM = pp.RANGE_LEN * pp.AGG_NUM;
+    size_t l = pp.vec_g.size();
+
+    for (auto j = 0; j < instance.C.size(); j++) transcript_str += ECP_ep2string(instance.C[j]);
+
+    BIGNUM *alpha = BN_new(), *rho = BN_new();
+    BN_random(alpha), BN_random(rho);
+    vector<BIGNUM *> vec_sL(l), vec_sR(l), vec_aR_offset(l);
+    BN_vec_new(vec_sL), BN_vec_new(vec_sR), BN_vec_new(vec_aR_offset);
+    for (auto i = 0; i < l; i++)
+    {
+        BN_random(vec_sL[i]), BN_random(vec_sR[i]);
+        if (i < NM) BN_copy(vec_aR_offset[i], vec_aR[i]);
+        else BN_mod_add(vec_aR_offset[i], vec_aR[i], BN_1, order, bn_ctx);
+    }
+
+    vector<EC_POINT *> vec_A = {pp.h};
+    vec_A.insert(vec_A.end(), pp.vec_g.begin(), pp.vec_g.end());
+    vec_A.insert(vec_A.end(), pp.vec_h.begin(), pp.vec_h.end());
+    vector<BIGNUM *> vec_a = {alpha};
+    vec_a.insert(vec_a.end(), vec_aL.begin(), vec_aL.end());
+    vec_a.insert(vec_a.end(), vec_aR_offset.begin(), vec_aR_offset.end());
+    ECP_vec_mul(proof.A, vec_A, vec_a, 1);
+    vec_a = {rho};
+    vec_a.insert(vec_a.end(), vec_sL.begin(), vec_sL.end());
+    vec_a.insert(vec_a.end(), vec_sR.begin(), vec_sR.end());
+    ECP_vec_mul(proof.S, vec_A, vec_a, 1);
+
+    BIGNUM *y = BN_new(), *y_inverse = BN_new(), *z = BN_new(), *x = BN_new(), *e = BN_new();
+    transcript_str += ECP_ep2string(proof.A);
+    Hash_String_to_BN(transcript_str, y);
+    BN_mod_inverse(y_inverse, y, order, bn_ctx);
+    transcript_str += ECP_ep2string(proof.S);
+    Hash_String_to_BN(transcript_str, z);
+
+    // l(X) = ll0 + ll1 X, r(X) = rr0 + rr1 X
+    vector<BIGNUM *> ll0(l), ll1(l), rr0(l), rr1(l);
+    BN_vec_new(ll0), BN_vec_new(ll1), BN_vec_new(rr0), BN_vec_new(rr1);
+    BIGNUM *y_power = BN_new(), *z_power = BN_new(), *bn_temp = BN_new();
+    BN_one(y_power);
+    for (auto i = 0; i < l; i++)
+    {
+        BN_mod_sub(ll0[i], vec_aL[i], z, order, bn_ctx);
+        BN_copy(ll1[i], vec_sL[i]);
+        BN_mod_add(rr0[i], vec_aR[i], z, order, bn_ctx);
+        BN_mod_mul(rr0[i], rr0[i], y_power, order, bn_ctx);
+        BN_mod_mul(rr1[i], vec_sR[i], y_power, order, bn_ctx);
+        if (i < NM)
+        {
+            // z^{j+1} 2^k for i = (j-1)n + k
+            BN_set_word(bn_temp, i / pp.RANGE_LEN + 2);
+            BN_mod_exp(z_power, z, bn_temp, order, bn_ctx);
+            BN_set_word(bn_temp, 1);
+            BN_lshift(bn_temp, bn_temp, i % pp.RANGE_LEN);
+            BN_mod_mul(bn_temp, bn_temp, z_power, order, bn_ctx);
+            BN_mod_add(rr0[i], rr0[i], bn_temp, order, bn_ctx);
+        }
+        BN_mod_mul(y_power, y_power, y, order, bn_ctx);
+    }
+
+    BIGNUM *t1 = BN_new(), *t2 = BN_new(), *tau1 = BN_new(), *tau2 = BN_new();
+    BN_zero(t1), BN_zero(t2);
+    for (auto i = 0; i < l; i++)
+    {
+        BN_mod_mul(bn_temp, ll1[i], rr0[i], order, bn_ctx);
+        BN_mod_add(t1, t1, bn_temp, order, bn_ctx);
+        BN_mod_mul(bn_temp, ll0[i], rr1[i], order, bn_ctx);
+        BN_mod_add(t1, t1, bn_temp, order, bn_ctx);
+        BN_mod_mul(bn_temp, ll1[i], rr1[i], order, bn_ctx);
+        BN_mod_add(t2, t2, bn_temp, order, bn_ctx);
+    }
+    BN_random(tau1), BN_random(tau2);
+    EC_POINT_mul(group, proof.T1, tau1, pp.h, t1, bn_ctx);
+    EC_POINT_mul(group, proof.T2, tau2, pp.h, t2, bn_ctx);
+    transcript_str += ECP_ep2string(proof.T1) + ECP_ep2string(proof.T2);
+    Hash_String_to_BN(transcript_str, x);
+
+    // llx, rrx, tx = <llx, rrx>, taux = tau1 x + tau2 x^2 + sum_j z^{j+1} r_j, mu = alpha + rho x
+    BN_zero(proof.tx);
+    for (auto i = 0; i < l; i++)
+    {
+        BN_mod_mul(ll1[i], ll1[i], x, order, bn_ctx);
+        BN_mod_add(ll0[i], ll0[i], ll1[i], order, bn_ctx);
+        BN_mod_mul(rr1[i], rr1[i], x, order, bn_ctx);
+        BN_mod_add(rr0[i], rr0[i], rr1[i], order, bn_ctx);
+        BN_mod_mul(bn_temp, ll0[i], rr0[i], order, bn_ctx);
+        BN_mod_add(proof.tx, proof.tx, bn_temp, order, bn_ctx);
+    }
+    BN_mod_mul(proof.taux, tau2, x, order, bn_ctx);
+    BN_mod_add(proof.taux, proof.taux, tau1, order, bn_ctx);
+    BN_mod_mul(proof.taux, proof.taux, x, order, bn_ctx);
+    BN_copy(z_power, z);
+    for (auto j = 0; j < pp.AGG_NUM; j++)
+    {
+        BN_mod_mul(z_power, z_power, z, order, bn_ctx);
+        BN_mod_mul(bn_temp, z_power, vec_r[j], order, bn_ctx);
+        BN_mod_add(proof.taux, proof.taux, bn_temp, order, bn_ctx);
+    }
+    BN_mod_mul(proof.mu, rho, x, order, bn_ctx);
+    BN_mod_add(proof.mu, proof.mu, alpha, order, bn_ctx);
+
+    // the inner product argument on vec_g, h'_i = h_i^{y^{-i}} and u^e
+    vector<EC_POINT *> vec_h_new(l);
+    ECP_vec_new(vec_h_new);
+    BN_one(y_power);
+    for (auto i = 0; i < l; i++)
+    {
+        EC_POINT_mul(group, vec_h_new[i], NULL, pp.vec_h[i], y_power, bn_ctx);
+        BN_mod_mul(y_power, y_power, y_inverse, order, bn_ctx);
+    }
+    transcript_str += BN_bn2string(x);
+    Hash_String_to_BN(transcript_str, e);
+    EC_POINT *ip_u = EC_POINT_new(group);
+    EC_POINT_mul(group, ip_u, NULL, pp.u, e, bn_ctx);
+    transcript_str += BN_bn2string(proof.tx) + BN_bn2string(proof.taux) + BN_bn2string(proof.mu);
+
+    PointVec vec_g_point, vec_h_point;
+    PointVec_from_ECP(vec_g_point, pp.vec_g, bn_ctx);
+    PointVec_from_ECP(vec_h_point, vec_h_new, bn_ctx);
+    Affine_Point u;
+    BIGNUM *bn_x = BN_new(), *bn_y = BN_new();
+    Affine_from_ECP(u, ip_u, bn_x, bn_y, bn_ctx);
+    ScalarVec llx, rrx;
+    ScalarVec_from_BN(llx, ll0, bn_ctx);
+    ScalarVec_from_BN(rrx, rr0, bn_ctx);
+    InnerProduct_Prove_Rounds(vec_g_point, vec_h_point, u, llx, rrx, transcript_str, proof.ip_proof, 1);
+
+    BN_free(alpha), BN_free(rho), BN_free(y), BN_free(y_inverse), BN_free(z), BN_free(x), BN_free(e);
+    BN_free(y_power), BN_free(z_power), BN_free(bn_temp), BN_free(bn_x), BN_free(bn_y);
+    BN_free(t1), BN_free(t2), BN_free(tau1), BN_free(tau2);
+    BN_vec_free(vec_sL), BN_vec_free(vec_sR), BN_vec_free(vec_aR_offset);
+    BN_vec_free(ll0), BN_vec_free(ll1), BN_vec_free(rr0), BN_vec_free(rr1);
+    ECP_vec_free(vec_h_new);
+    EC_POINT_free(ip_u);
+}
+
+/*
+    a forgery through the padding: C_0 commits to v = 2 with RANGE_LEN = 1, AGG_NUM = 3 (nm = 3, padded to 4),
+    and the prover puts bits on the padded generators to cancel the non-binary coordinate
+*/
+void test_padding_forgery()
+{
+    size_t RANGE_LEN = 1, AGG_NUM = 3;
+    Bullet_PP pp;
+    Bullet_PP_new(pp, RANGE_LEN, AGG_NUM);
+    Bullet_Setup(pp, RANGE_LEN, AGG_NUM);
+    size_t l = pp.vec_g.size();
+
+    Bullet_Instance instance;
+    Bullet_Instance_new(pp, instance);
+    Bullet_Witness witness;
+    Bullet_Witness_new(pp, witness);
+    for (auto j = 0; j < AGG_NUM; j++)
+    {
+        BN_random(witness.r[j]);
+        BN_set_word(witness.v[j], j % 2);
+    }
+    Bullet_Commit(pp, instance, witness);
+
+    vector<BIGNUM *> vec_aL(l), vec_aR(l);
+    BN_vec_new(vec_aL), BN_vec_new(vec_aR);
+    for (auto i = 0; i < l; i++)
+    {
+        BN_set_word(vec_aL[i], i < AGG_NUM ? i % 2 : 0);
+        BN_mod_sub(vec_aR[i], vec_aL[i], BN_1, order, bn_ctx);
+    }
+
+    // sanity: the forging prover makes valid proofs of honest witnesses, even with sL, sR on the padding
+    Bullet_Proof proof;
+    Bullet_Proof_new(proof);
+    string transcript_str = "forge";
+    Forge_Prove(pp, instance, witness.r, vec_aL, vec_aR, transcript_str, proof);
+    check(Bullet_Verify(pp, instance, "forge", proof), true, "honest proof of the forging prover");
+    Bullet_Proof_free(proof);
+
+    // aL_0 = 2, aR_0 = 1: <aL, y^l o aR> picks up 2, to be cancelled by aL_3 = 1, aR_3 = -2 on the padding
+    BN_set_word(witness.v[0], 2);
+    Bullet_Commit(pp, instance, witness);
+    BN_set_word(vec_aL[0], 2), BN_set_word(vec_aR[0], 1);
+    BN_set_word(vec_aL[l-1], 1), BN_set_word(vec_aR[l-1], 2);
+    BN_mod_sub(vec_aR[l-1], BN_0, vec_aR[l-1], order, bn_ctx);
+    Bullet_Proof_new(proof);
+    transcript_str = "forge";
+    Forge_Prove(pp, instance, witness.r, vec_aL, vec_aR, transcript_str, proof);
+    check(Bullet_Verify(pp, instance, "forge", proof), false, "forged proof of v = 2 on the padding");
+    Bullet_Proof_free(proof);
+
+    BN_vec_free(vec_aL), BN_vec_free(vec_aR);
+    Bullet_Instance_free(instance);
+    Bullet_Witness_free(witness);
+    Bullet_PP_free(pp);
+}
+
+/* random witness with values of RANGE_LEN bits, and its commitments */
+void random_instance_witness(Bullet_PP &pp, Bullet_Instance &instance, Bullet_Witness &witness)
+{
+    Bullet_Instance_new(pp, instance);
+    Bullet_Witness_new(pp, witness);
+    for (auto j = 0; j < pp.AGG_NUM; j++)
+    {
+        BN_random(witness.r[j]);
+        BN_rand(witness.v[j], pp.RANGE_LEN, BN_RAND_TOP_ANY, BN_RAND_BOTTOM_ANY);
+    }
+    Bullet_Commit(pp, instance, witness);
+}
+
+/* valid proofs verify (twice, with the same answer), tampered proofs and out-of-range values are rejected */
+void test_verify(size_t RANGE_LEN, size_t AGG_NUM, size_t WINDOW_LEN)
+{
+    string note = to_string(RANGE_LEN) + "x" + to_string(AGG_NUM) + " WINDOW_LEN = " + to_string(WINDOW_LEN) + ": ";
+    Bullet_PP pp;
+    Bullet_PP_new(pp, RANGE_LEN, AGG_NUM);
+    Bullet_Setup(pp, RANGE_LEN, AGG_NUM);
+    if (WINDOW_LEN > 0) Bullet_PP_precompute(pp, WINDOW_LEN);
+
+    Bullet_Instance instance;
+    Bullet_Witness witness;
+    random_instance_witness(pp, instance, witness);
+
+    Bullet_Proof proof;
+    Bullet_Proof_new(proof);
+    string transcript_str = "test";
+    Bullet_Prove(pp, instance, witness, transcript_str, proof);
+    check(Bullet_Verify(pp, instance, "test", proof), true, note + "valid proof");
+    check(Bullet_Verify(pp, instance, "test", proof), true, note + "valid proof verified twice");
+    check(Bullet_Verify(pp, instance, "other", proof), false, note + "other transcript");
+
+    for (auto a : {proof.tx, proof.taux, proof.mu, proof.ip_proof.a, proof.ip_proof.b})
+    {
+        BN_add_word(a, 1);
+        check(Bullet_Verify(pp, instance, "test", proof), false, note + "tampered scalar");
+        BN_sub_word(a, 1);
+    }
+    vector<EC_POINT *> vec_A = {proof.A, proof.S, proof.T1, proof.T2, instance.C[0]};
+    vec_A.insert(vec_A.end(), proof.ip_proof.vec_L.begin(), proof.ip_proof.vec_L.end());
+    vec_A.insert(vec_A.end(), proof.ip_proof.vec_R.begin(), proof.ip_proof.vec_R.end());
+    EC_POINT *A_copy = EC_POINT_new(group);
+    for (auto A : vec_A)
+    {
+        EC_POINT_copy(A_copy, A);
+        EC_POINT_add(group, A, A, pp.g, bn_ctx);
+        check(Bullet_Verify(pp, instance, "test", proof), false, note + "tampered point");
+        EC_POINT_copy(A, A_copy);
+    }
+    EC_POINT_free(A_copy);
+    check(Bullet_Verify(pp, instance, "test", proof), true, note + "valid proof after restoring");
+    Bullet_Proof_free(proof);
+
+    // v = 2^RANGE_LEN in the last commitment
+    BN_set_word(witness.v[AGG_NUM-1], 1);
+    BN_lshift(witness.v[AGG_NUM-1], witness.v[AGG_NUM-1], RANGE_LEN);
+    Bullet_Commit(pp, instance, witness);
+    Bullet_Proof_new(proof);
+    transcript_str = "test";
+    Bullet_Prove(pp, instance, witness, transcript_str, proof);
+    check(Bullet_Verify(pp, instance, "test", proof), false, note + "out-of-range value");
+    Bullet_Proof_free(proof);
+
+    Bullet_Instance_free(instance);
+    Bullet_Witness_free(witness);
+    Bullet_PP_free(pp);
+}
+
+/* a batch is accepted iff all of its proofs are valid */
+void test_batch_verify(size_t RANGE_LEN, size_t AGG_NUM, size_t BATCH_NUM)
+{
+    string note = "batch of " + to_string(BATCH_NUM) + " " + to_string(RANGE_LEN) + "x" + to_string(AGG_NUM) + ": ";
+    Bullet_PP pp;
+    Bullet_PP_new(pp, RANGE_LEN, AGG_NUM);
+    Bullet_Setup(pp, RANGE_LEN, AGG_NUM);
+
+    vector<Bullet_Instance> vec_instance(BATCH_NUM);
+    vector<Bullet_Witness> vec_witness(BATCH_NUM);
+    vector<string> vec_transcript_str(BATCH_NUM);
+    vector<Bullet_Proof> vec_proof(BATCH_NUM);
+    for (auto k = 0; k < BATCH_NUM; k++)
+    {
+        random_instance_witness(pp, vec_instance[k], vec_witness[k]);
+        vec_transcript_str[k] = "batch" + to_string(k);
+        string transcript_str = vec_transcript_str[k];
+        Bullet_Proof_new(vec_proof[k]);
+        Bullet_Prove(pp, vec_instance[k], vec_witness[k], transcript_str, vec_proof[k]);
+    }
+    check(Bullet_Batch_Verify(pp, vec_instance, vec_transcript_str, vec_proof), true, note + "valid batch");
+
+    size_t k = BATCH_NUM/2;
+    vec_transcript_str[k] = "other";
+    check(Bullet_Batch_Verify(pp, vec_instance, vec_transcript_str, vec_proof), false, note + "one wrong transcript");
+    vec_transcript_str[k] = "batch" + to_string(k);
+
+    BN_add_word(vec_proof[k].taux, 1);
+    check(Bullet_Batch_Verify(pp, vec_instance, vec_transcript_str, vec_proof), false, note + "one tampered proof");
+    BN_sub_word(vec_proof[k].taux, 1);
+
+    // one proof of an out-of-range value
+    BN_set_word(vec_witness[k].v[0], 1);
+    BN_lshift(vec_witness[k].v[0], vec_witness[k].v[0], RANGE_LEN);
+    Bullet_Commit(pp, vec_instance[k], vec_witness[k]);
+    Bullet_Proof_free(vec_proof[k]);
+    Bullet_Proof_new(vec_proof[k]);
+    string transcript_str = vec_transcript_str[k];
+    Bullet_Prove(pp, vec_instance[k], vec_witness[k], transcript_str, vec_proof[k]);
+    check(Bullet_Batch_Verify(pp, vec_instance, vec_transcript_str, vec_proof), false, note + "one out-of-range value");
+
+    for (auto k = 0; k < BATCH_NUM; k++)
+    {
+        Bullet_Instance_free(vec_instance[k]);
+        Bullet_Witness_free(vec_witness[k]);
+        Bullet_Proof_free(vec_proof[k]);
+    }
+    Bullet_PP_free(pp);
+}
+
+/* the bit proof of N twisted ElGamal ciphertexts: bits are accepted, a ciphertext of 2 is rejected */
+void test_bit_proof(Twisted_ElGamal_PP &pp_tt, Twisted_ElGamal_KP &keypair, size_t BIT_NUM)
+{
+    string note = "bit proof of " + to_string(BIT_NUM) + " ciphertexts: ";
+    Bullet_PP pp;
+    Bit_PP_new(pp, BIT_NUM);
+    Bit_Setup(pp, pp_tt, BIT_NUM);
+
+    vector<Twisted_ElGamal_CT> vec_CT(BIT_NUM);
+    vector<BIGNUM *> vec_r(BIT_NUM), vec_m(BIT_NUM);
+    BN_vec_new(vec_r);
+    BN_vec_new(vec_m);
+    for (auto j = 0; j < BIT_NUM; j++)
+    {
+        Twisted_ElGamal_CT_new(vec_CT[j]);
+        BN_random(vec_r[j]);
+        BN_set_word(vec_m[j], j % 2);
+        Twisted_ElGamal_Enc(pp_tt, keypair.pk, vec_m[j], vec_r[j], vec_CT[j]);
+    }
+
+    Bullet_Proof proof;
+    Bullet_Proof_new(proof);
+    string transcript_str = "bit";
+    Bit_Prove(pp, vec_CT, vec_r, vec_m, transcript_str, proof);
+    check(Bit_Verify(pp, vec_CT, "bit", proof), true, note + "valid proof");
+    Bullet_Proof_free(proof);
+
+    BN_set_word(vec_m[0], 2);
+    Twisted_ElGamal_Enc(pp_tt, keypair.pk, vec_m[0], vec_r[0], vec_CT[0]);
+    Bullet_Proof_new(proof);
+    transcript_str = "bit";
+    Bit_Prove(pp, vec_CT, vec_r, vec_m, transcript_str, proof);
+    check(Bit_Verify(pp, vec_CT, "bit", proof), false, note + "ciphertext of 2");
+    Bullet_Proof_free(proof);
+
+    for (auto j = 0; j < BIT_NUM; j++) Twisted_ElGamal_CT_free(vec_CT[j]);
+    BN_vec_free(vec_r);
+    BN_vec_free(vec_m);
+    Bullet_PP_free(pp);
+}
+
+int main()
+{
+    // curve id = NID_secp256k1
+    global_initialize(NID_secp256k1);
+
+    test_padding_forgery();
+    test_pp_file(16, 4);
+    test_pp_file(7, 3);
+    for (auto WINDOW_LEN : {0, 32})
+    {
+        test_verify(8, 1, WINDOW_LEN);
+        test_verify(16, 4, WINDOW_LEN);
+        test_verify(1, 3, WINDOW_LEN);
+        test_verify(7, 3, WINDOW_LEN);
+        test_verify(64, 5, WINDOW_LEN);
+    }
+    test_batch_verify(16, 2, 4);
+    test_batch_verify(5, 3, 3);
+
+    Twisted_ElGamal_PP pp_tt;
+    Twisted_ElGamal_PP_new(pp_tt);
+    size_t MSG_LEN = 32;
+    size_t TUNNING = 7;
+    size_t IO_THREAD_NUM = 4;
+    size_t DEC_THREAD_NUM = 4;
+    Twisted_ElGamal_Setup(pp_tt, MSG_LEN, TUNNING, IO_THREAD_NUM, DEC_THREAD_NUM);
+    Twisted_ElGamal_KP keypair;
+    Twisted_ElGamal_KP_new(keypair);
+    Twisted_ElGamal_KeyGen(pp_tt, keypair);
+    for (auto BIT_NUM : {1, 3, 37, 64}) test_bit_proof(pp_tt, keypair, BIT_NUM);
+    Twisted_ElGamal_PP_free(pp_tt);
+    Twisted_ElGamal_KP_free(keypair);
+
+    global_finalize();
+
+    if(FAIL_NUM > 0)
+    {
+        cout << FAIL_NUM << " checks failed" << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "all checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,498 @@
+#include "../depends/common/global.hpp"
+#include "../depends/common/routines.hpp"
+#include "../depends/twisted_elgamal/twisted_elgamal.hpp"
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+/*
+    regression tests of the DLOG algorithms on small tables: exits with EXIT_FAILURE if a check fails
+*/
+
+size_t FAIL_NUM = 0;
+
+void check(bool result, bool expected, string note)
+{
+    if(result == expected) return;
+    FAIL_NUM++;
+    cout << "FAIL: " << note << endl;
+}
+
+const size_t RANGE_LEN = 24;
+const size_t TUNNING = 0;  // loop_num = 2^12 giant steps, i.e. 16 chunks of DLOG_CHUNK_LEN
+const uint64_t RANGE_SIZE = uint64_t(1) << RANGE_LEN;
+
+const size_t KANGAROO_RANGE_LEN = 24;
+const size_t KANGAROO_TABLE_LEN = 8;
+
+mt19937_64 prng(2019);
+
+/* vec_h[k] = g^vec_value[k] */
+void targets_new(EC_POINT *&g, const vector<uint64_t> &vec_value, vector<EC_POINT *> &vec_h)
+{
+    BIGNUM *BN_value = BN_new();
+    vec_h.resize(vec_value.size());
+    ECP_vec_new(vec_h);
+    for (auto k = 0; k < vec_value.size(); k++)
+    {
+        BN_set_word(BN_value, vec_value[k]);
+        EC_POINT_mul(group, vec_h[k], NULL, g, BN_value, bn_ctx);
+    }
+    BN_free(BN_value);
+}
+
+/* an in-range value must be found with its DLOG, an out-of-range one must be reported as not found */
+void check_result(const vector<uint64_t> &vec_value, vector<BIGNUM *> &vec_x, vector<int> &vec_finding, string note)
+{
+    for (auto k = 0; k < vec_value.size(); k++)
+    {
+        string target_note = note + "target " + to_string(k) + " = " + to_string(vec_value[k]);
+        bool in_range = vec_value[k] < RANGE_SIZE;
+        check(vec_finding[k] == 1, in_range, target_note + " finding");
+        if (in_range && vec_finding[k] == 1) check(BN_get_word(vec_x[k]) == vec_value[k], true, target_note + " DLOG");
+    }
+}
+
+/* batch DLOG over mixed in-range and out-of-range targets, including duplicates that retire in the same round */
+void test_batch(EC_POINT *&g)
+{
+    vector<uint64_t> vec_value = {0, 1, RANGE_SIZE - 2, RANGE_SIZE - 1, RANGE_SIZE, RANGE_SIZE + 12345, 77, 77,
+                                  RANGE_SIZE + 1, RANGE_SIZE + 1, ~uint64_t(0)};
+    for (auto k = 0; k < 20; k++) vec_value.push_back(prng() % RANGE_SIZE);
+    vec_value.push_back(vec_value.back());
+
+    vector<EC_POINT *> vec_h;
+    targets_new(g, vec_value, vec_h);
+    vector<BIGNUM *> vec_x(vec_value.size());
+    BN_vec_new(vec_x);
+    vector<int> vec_finding;
+
+    Shanks_DLOG_Batch(vec_x, g, vec_h, RANGE_LEN, TUNNING, vec_finding);
+    check_result(vec_value, vec_x, vec_finding, "Shanks_DLOG_Batch: ");
+
+    for (auto DEC_THREAD_NUM : {1, 3, 64})
+    {
+        Parallel_Shanks_DLOG_Batch(vec_x, g, vec_h, RANGE_LEN, TUNNING, DEC_THREAD_NUM, vec_finding);
+        check_result(vec_value, vec_x, vec_finding,
+                     "Parallel_Shanks_DLOG_Batch with " + to_string(DEC_THREAD_NUM) + " threads: ");
+    }
+
+    // a batch of one target and an empty batch
+    vector<EC_POINT *> vec_h_one = {vec_h[2]};
+    vector<BIGNUM *> vec_x_one = {vec_x[2]};
+    Shanks_DLOG_Batch(vec_x_one, g, vec_h_one, RANGE_LEN, TUNNING, vec_finding);
+    check_result({vec_value[2]}, vec_x_one, vec_finding, "batch of one: ");
+    vector<EC_POINT *> vec_h_empty;
+    vector<BIGNUM *> vec_x_empty;
+    Parallel_Shanks_DLOG_Batch(vec_x_empty, g, vec_h_empty, RANGE_LEN, TUNNING, 4, vec_finding);
+    check(vec_finding.empty(), true, "empty batch");
+
+    ECP_vec_free(vec_h);
+    BN_vec_free(vec_x);
+}
+
+/* single-target search over both ends of the range with thread numbers that do not divide the chunk number */
+void test_single(EC_POINT *&g)
+{
+    vector<uint64_t> vec_value = {0, 1, RANGE_SIZE - 2, RANGE_SIZE - 1, RANGE_SIZE, RANGE_SIZE + 12345};
+    for (auto k = 0; k < 4; k++) vec_value.push_back(prng() % RANGE_SIZE);
+
+    vector<EC_POINT *> vec_h;
+    targets_new(g, vec_value, vec_h);
+    BIGNUM *x = BN_new();
+    for (auto k = 0; k < vec_value.size(); k++)
+    {
+        string target_note = "target " + to_string(vec_value[k]);
+        bool in_range = vec_value[k] < RANGE_SIZE;
+        if (in_range)
+        {
+            check(Shanks_DLOG(x, g, vec_h[k], RANGE_LEN, TUNNING), true, "Shanks_DLOG: " + target_note + " finding");
+            check(BN_get_word(x) == vec_value[k], true, "Shanks_DLOG: " + target_note + " DLOG");
+        }
+        for (auto DEC_THREAD_NUM : {1, 3, 7})
+        {
+            string thread_note = "Parallel_Shanks_DLOG with " + to_string(DEC_THREAD_NUM) + " threads: " + target_note;
+            DLOG_Status status = Parallel_Shanks_DLOG(x, g, vec_h[k], RANGE_LEN, TUNNING, DEC_THREAD_NUM);
+            check(status == (in_range ? DLOG_FOUND : DLOG_NOT_FOUND), true, thread_note + " status");
+            if (in_range && status == DLOG_FOUND) check(BN_get_word(x) == vec_value[k], true, thread_note + " DLOG");
+        }
+    }
+
+    // a cancel flag raised before the search stops it whether the target is in range or not
+    std::atomic<bool> cancel(true);
+    for (auto DEC_THREAD_NUM : {1, 7})
+    {
+        for (auto k : {3, 4})
+        {
+            check(Parallel_Shanks_DLOG(x, g, vec_h[k], RANGE_LEN, TUNNING, DEC_THREAD_NUM, &cancel) == DLOG_CANCELLED,
+                  true, "cancelled search with " + to_string(DEC_THREAD_NUM) + " threads: target " + to_string(vec_value[k]));
+        }
+    }
+
+    BN_free(x);
+    ECP_vec_free(vec_h);
+}
+
+string FILE_content(string file_name)
+{
+    ifstream fin(file_name, ios::binary);
+    stringstream content;
+    content << fin.rdbuf();
+    return content.str();
+}
+
+/* generate [0, end_index) in a child process that is killed after stop_num chunks have been recorded */
+void generate_interrupted(EC_POINT *&g, string hashmap_file, uint64_t end_index, size_t stop_num)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        size_t call_num = 0;
+        Parallel_HASHMAP_generate(g, hashmap_file, 0, end_index, 3, [&](uint64_t, uint64_t, double) {
+            if (++call_num == stop_num) _exit(EXIT_SUCCESS);
+        });
+        _exit(EXIT_FAILURE);
+    }
+    int child_status;
+    waitpid(pid, &child_status, 0);
+    check(WIFEXITED(child_status) && WEXITSTATUS(child_status) == EXIT_SUCCESS, true, "interrupted generation");
+}
+
+/* resumed generation after an interruption and a torn checkpoint record must equal a clean generation */
+void test_generate(EC_POINT *&g)
+{
+    string hashmap_file = "test_dlog_" + to_string(getpid()) + ".generate";
+    string partial_file = hashmap_file + ".partial";
+    string checkpoint_file = hashmap_file + ".checkpoint";
+    uint64_t end_index = 4*HASHMAP_CHUNK_LEN + 1000; // the last chunk is a short one
+
+    Parallel_HASHMAP_generate(g, hashmap_file, 0, end_index, 3);
+    string clean_content = FILE_content(hashmap_file);
+    check(clean_content.size() == end_index*POINT_LEN, true, "clean generation size");
+    remove(hashmap_file.c_str());
+
+    // the chunked generation writes the same file as HASHMAP_serialize
+    string table_file = "test_dlog_" + to_string(getpid()) + ".table";
+    Parallel_HASHMAP_generate(g, hashmap_file, 0, uint64_t(1) << (RANGE_LEN/2 + TUNNING), 2);
+    check(FILE_content(hashmap_file) == FILE_content(table_file), true, "chunked generation vs HASHMAP_serialize");
+    remove(hashmap_file.c_str());
+
+    generate_interrupted(g, hashmap_file, end_index, 2);
+    check(FILE_exist(partial_file) && FILE_exist(checkpoint_file) && !FILE_exist(hashmap_file), true,
+          "interrupted generation leaves the partial and checkpoint files");
+    ofstream(checkpoint_file, ios::binary | ios::app).write("\x03\x00\x00", 3); // a torn checkpoint record
+
+    vector<uint64_t> vec_done, vec_total;
+    Parallel_HASHMAP_generate(g, hashmap_file, 0, end_index, 2, [&](uint64_t done, uint64_t total, double) {
+        vec_done.push_back(done);
+        vec_total.push_back(total);
+    });
+    check(FILE_content(hashmap_file) == clean_content, true, "resumed generation vs clean generation");
+    check(FILE_exist(partial_file) || FILE_exist(checkpoint_file), false, "resumed generation cleans up");
+    // 2 chunks were recorded, so the rerun generates and reports the other 3 chunks
+    check(vec_done.size() == 3, true, "progress call number");
+    check(!vec_done.empty() && vec_done.front() > 2*HASHMAP_CHUNK_LEN, true, "progress starts after the resumed chunks");
+    check(!vec_done.empty() && vec_done.back() == end_index, true, "progress ends at the total");
+    for (auto k = 0; k < vec_done.size(); k++)
+    {
+        check(vec_total[k] == end_index, true, "progress total");
+        if (k > 0) check(vec_done[k] > vec_done[k-1], true, "progress increases");
+    }
+    remove(hashmap_file.c_str());
+
+    // a checkpoint of another job is discarded
+    generate_interrupted(g, hashmap_file, end_index + HASHMAP_CHUNK_LEN, 2);
+    vec_done.clear();
+    Parallel_HASHMAP_generate(g, hashmap_file, 0, end_index, 2, [&](uint64_t done, uint64_t, double) {
+        vec_done.push_back(done);
+    });
+    check(FILE_content(hashmap_file) == clean_content, true, "generation over a foreign checkpoint");
+    check(vec_done.size() == 5, true, "generation over a foreign checkpoint starts from scratch");
+    remove(hashmap_file.c_str());
+}
+
+/* run task in a child process and return its exit status (-1 if it did not exit) */
+int child_status(std::function<int()> task)
+{
+    pid_t pid = fork();
+    if (pid == 0) _exit(task());
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/* EXIT_SUCCESS iff all targets are decrypted correctly with the current table */
+int decrypt_status(EC_POINT *&g, const vector<uint64_t> &vec_value, vector<EC_POINT *> &vec_h)
+{
+    BIGNUM *x = BN_new();
+    int status = EXIT_SUCCESS;
+    for (auto k = 0; k < vec_value.size(); k++)
+    {
+        if (Parallel_Shanks_DLOG(x, g, vec_h[k], RANGE_LEN, TUNNING, 3) != DLOG_FOUND || BN_get_word(x) != vec_value[k])
+            status = EXIT_FAILURE;
+    }
+    BN_free(x);
+    return status;
+}
+
+/* publish the table to shared memory, attach to it from other processes, reject mismatches and stale segments */
+void test_shared(EC_POINT *&g, string table_file)
+{
+    string shm_name = "/test_dlog_" + to_string(getpid());
+    string unfinished_name = shm_name + "_unfinished";
+    vector<uint64_t> vec_value = {0, 1, RANGE_SIZE - 1, prng() % RANGE_SIZE};
+    vector<EC_POINT *> vec_h;
+    targets_new(g, vec_value, vec_h);
+
+    HASHMAP_publish(g, table_file, shm_name, RANGE_LEN, TUNNING);
+    check(decrypt_status(g, vec_value, vec_h) == EXIT_SUCCESS, true, "decryption with the published table");
+    check(child_status([&]() {
+        HASHMAP_free();
+        if (HASHMAP_attach(g, shm_name, RANGE_LEN, TUNNING) == false) return EXIT_FAILURE;
+        return decrypt_status(g, vec_value, vec_h);
+    }) == EXIT_SUCCESS, true, "decryption with the attached table");
+    check(child_status([&]() {
+        HASHMAP_free();
+        HASHMAP_publish(g, table_file, shm_name, RANGE_LEN, TUNNING); // published already: attaches
+        return decrypt_status(g, vec_value, vec_h);
+    }) == EXIT_SUCCESS, true, "decryption after a second publish");
+
+    // a segment of other parameters is rejected: other size, same size with other RANGE_LEN, other g
+    check(child_status([&]() {
+        HASHMAP_attach(g, shm_name, RANGE_LEN, TUNNING + 1);
+        return EXIT_SUCCESS;
+    }) == EXIT_FAILURE, true, "attaching with a mismatched TUNNING");
+    check(child_status([&]() {
+        HASHMAP_attach(g, shm_name, RANGE_LEN + 1, TUNNING);
+        return EXIT_SUCCESS;
+    }) == EXIT_FAILURE, true, "attaching with a mismatched RANGE_LEN");
+    check(child_status([&]() {
+        EC_POINT *g_other = EC_POINT_new(group);
+        EC_POINT_dbl(group, g_other, g, bn_ctx);
+        HASHMAP_attach(g_other, shm_name, RANGE_LEN, TUNNING);
+        return EXIT_SUCCESS;
+    }) == EXIT_FAILURE, true, "attaching with a mismatched g");
+
+    // a publisher that died after sizing the segment leaves it incomplete: attaching times out
+    int fd = shm_open(unfinished_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    uint64_t slot_num;
+    check(fd >= 0 && ftruncate(fd, HASHMAP_region_len(uint64_t(1) << (RANGE_LEN/2 + TUNNING), slot_num)) == 0, true,
+          "creating an unfinished segment");
+    close(fd);
+    auto start_time = chrono::steady_clock::now();
+    check(child_status([&]() {
+        HASHMAP_attach(g, unfinished_name, RANGE_LEN, TUNNING, 1);
+        return EXIT_SUCCESS;
+    }) == EXIT_FAILURE, true, "attaching to an unfinished segment");
+    check(chrono::steady_clock::now() - start_time >= chrono::seconds(1), true, "attaching waits for the publisher");
+
+    // unlinked segments cannot be attached anymore, the mapped table stays usable
+    HASHMAP_unlink(shm_name);
+    HASHMAP_unlink(unfinished_name);
+    check(child_status([&]() {
+        return HASHMAP_attach(g, shm_name, RANGE_LEN, TUNNING) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }) == EXIT_SUCCESS, true, "attaching to an unlinked segment");
+    check(decrypt_status(g, vec_value, vec_h) == EXIT_SUCCESS, true, "decryption after unlinking");
+
+    HASHMAP_deserialize(table_file, RANGE_LEN, TUNNING);
+    ECP_vec_free(vec_h);
+}
+
+/* 
+    degraded search on a loaded prefix whose size does not divide 2^RANGE_LEN: 
+    the last giant step passes 2^RANGE_LEN, and hits there must be rejected
+*/
+void test_degraded(EC_POINT *&g)
+{
+    uint64_t loaded_num = 1000;
+    vector<uint64_t> vec_value = {0, 1, loaded_num - 1, loaded_num, RANGE_SIZE - 1, RANGE_SIZE, RANGE_SIZE + 5,
+                                  prng() % RANGE_SIZE};
+    vector<EC_POINT *> vec_h;
+    targets_new(g, vec_value, vec_h);
+    vector<BIGNUM *> vec_x(vec_value.size());
+    BN_vec_new(vec_x);
+    vector<int> vec_finding(vec_value.size());
+
+    point2index_table.header->loaded_num.store(loaded_num);
+    uint64_t giantstep_size, loop_num, range_size;
+    HASHMAP_steps(RANGE_LEN, TUNNING, giantstep_size, loop_num, range_size);
+    check(giantstep_size == loaded_num && range_size == RANGE_SIZE && giantstep_size*loop_num > RANGE_SIZE + 5, true,
+          "degraded steps");
+
+    for (auto k = 0; k < vec_value.size(); k++) vec_finding[k] = Shanks_DLOG(vec_x[k], g, vec_h[k], RANGE_LEN, TUNNING);
+    check_result(vec_value, vec_x, vec_finding, "degraded Shanks_DLOG: ");
+    for (auto DEC_THREAD_NUM : {1, 3})
+    {
+        for (auto k = 0; k < vec_value.size(); k++)
+        {
+            vec_finding[k] = Parallel_Shanks_DLOG(vec_x[k], g, vec_h[k], RANGE_LEN, TUNNING, DEC_THREAD_NUM) == DLOG_FOUND;
+        }
+        check_result(vec_value, vec_x, vec_finding,
+                     "degraded Parallel_Shanks_DLOG with " + to_string(DEC_THREAD_NUM) + " threads: ");
+    }
+    Shanks_DLOG_Batch(vec_x, g, vec_h, RANGE_LEN, TUNNING, vec_finding);
+    check_result(vec_value, vec_x, vec_finding, "degraded Shanks_DLOG_Batch: ");
+    Parallel_Shanks_DLOG_Batch(vec_x, g, vec_h, RANGE_LEN, TUNNING, 3, vec_finding);
+    check_result(vec_value, vec_x, vec_finding, "degraded Parallel_Shanks_DLOG_Batch: ");
+
+    point2index_table.header->loaded_num.store(point2index_table.header->entry_num);
+    ECP_vec_free(vec_h);
+    BN_vec_free(vec_x);
+}
+
+/* decryptions during warm-up return once the table loaded by a background thread is searchable */
+void test_warmup(EC_POINT *&g, string table_file)
+{
+    Twisted_ElGamal_PP pp;
+    pp.DLOG_METHOD = DLOG_SHANKS;
+    vector<uint64_t> vec_value = {RANGE_SIZE - 1};
+    vector<EC_POINT *> vec_h;
+    targets_new(g, vec_value, vec_h);
+    BIGNUM *x = BN_new();
+
+    for (auto DEC_WARMUP_WAIT : {uint64_t(10), DLOG_WAIT_FOREVER})
+    {
+        string note = "warm-up with DEC_WARMUP_WAIT = " + to_string(DEC_WARMUP_WAIT) + ": ";
+        pp.DEC_WARMUP_WAIT = DEC_WARMUP_WAIT;
+        HASHMAP_reserve(RANGE_LEN, TUNNING);
+        auto start_time = chrono::steady_clock::now();
+        dlog_table_ready = std::async(std::launch::async, [table_file]{
+            this_thread::sleep_for(chrono::milliseconds(200));
+            HASHMAP_load(table_file);
+        }).share();
+
+        Twisted_ElGamal_Warmup(pp);
+        check(HASHMAP_empty(), false, note + "searchable table");
+        check(chrono::steady_clock::now() - start_time >= chrono::milliseconds(200), true, note + "waits for the loader");
+        check(Parallel_Shanks_DLOG(x, g, vec_h[0], RANGE_LEN, TUNNING, 3) == DLOG_FOUND && BN_get_word(x) == vec_value[0],
+              true, note + "decryption");
+        dlog_table_ready.wait();
+
+        start_time = chrono::steady_clock::now();
+        Twisted_ElGamal_Warmup(pp);
+        check(chrono::steady_clock::now() - start_time < chrono::milliseconds(100), true, note + "complete table");
+    }
+    dlog_table_ready = std::shared_future<void>();
+
+    BN_free(x);
+    ECP_vec_free(vec_h);
+}
+
+/* extending a table must give the same file as building the larger table from scratch */
+void test_grow(EC_POINT *&g, string table_file)
+{
+    string grow_file = "test_dlog_" + to_string(getpid()) + ".grow";
+    string fresh_file = "test_dlog_" + to_string(getpid()) + ".fresh";
+    ofstream(grow_file, ios::binary) << FILE_content(table_file);
+
+    // within the first chunk (TUNNING -> TUNNING+1), then over a chunk boundary (TUNNING+1 -> TUNNING+5)
+    for (auto TUNNING_NEW : {TUNNING + 1, TUNNING + 5})
+    {
+        string note = "grow to TUNNING = " + to_string(TUNNING_NEW);
+        Parallel_HASHMAP_grow(g, grow_file, RANGE_LEN, TUNNING_NEW, 3);
+        Parallel_HASHMAP_generate(g, fresh_file, 0, uint64_t(1) << (RANGE_LEN/2 + TUNNING_NEW), 3);
+        check(FILE_content(grow_file) == FILE_content(fresh_file), true, note);
+        remove(fresh_file.c_str());
+    }
+
+    // a larger table is left as it is
+    string grown_content = FILE_content(grow_file);
+    Parallel_HASHMAP_grow(g, grow_file, RANGE_LEN, TUNNING + 1, 3);
+    check(FILE_content(grow_file) == grown_content, true, "grow to a smaller TUNNING");
+
+    // an empty file is built from scratch
+    ofstream(grow_file, ios::binary | ios::trunc).close();
+    Parallel_HASHMAP_grow(g, grow_file, RANGE_LEN, TUNNING + 1, 3);
+    Parallel_HASHMAP_generate(g, fresh_file, 0, uint64_t(1) << (RANGE_LEN/2 + TUNNING + 1), 3);
+    check(FILE_content(grow_file) == FILE_content(fresh_file), true, "grow an empty file");
+
+    // a table of another generator is rejected
+    check(child_status([&]() {
+        EC_POINT *g_other = EC_POINT_new(group);
+        EC_POINT_dbl(group, g_other, g, bn_ctx);
+        Parallel_HASHMAP_grow(g_other, grow_file, RANGE_LEN, TUNNING + 2, 3);
+        return EXIT_SUCCESS;
+    }) == EXIT_FAILURE, true, "grow a table of another generator");
+
+    remove(grow_file.c_str());
+    remove(fresh_file.c_str());
+}
+
+/* kangaroo over the ends of the range and random values, with a serialized small table and 0, 1, 4 threads */
+void test_kangaroo(EC_POINT *&g)
+{
+    uint64_t range_size = uint64_t(1) << KANGAROO_RANGE_LEN;
+    vector<uint64_t> vec_value = {0, 1, range_size - 2, range_size - 1};
+    for (auto k = 0; k < 8; k++) vec_value.push_back(prng() % range_size);
+
+    vector<EC_POINT *> vec_h;
+    targets_new(g, vec_value, vec_h);
+    BIGNUM *x = BN_new();
+    for (auto k = 0; k < vec_value.size(); k++)
+    {
+        string target_note = "Kangaroo target " + to_string(vec_value[k]);
+        check(Kangaroo_DLOG(x, g, vec_h[k], KANGAROO_RANGE_LEN, KANGAROO_TABLE_LEN) == KANGAROO_FOUND, true,
+              target_note + " finding");
+        check(BN_get_word(x) == vec_value[k], true, target_note + " DLOG");
+        for (auto DEC_THREAD_NUM : {0, 4})
+        {
+            string thread_note = target_note + " with " + to_string(DEC_THREAD_NUM) + " threads";
+            check(Parallel_Kangaroo_DLOG(x, g, vec_h[k], KANGAROO_RANGE_LEN, KANGAROO_TABLE_LEN, DEC_THREAD_NUM)
+                  == KANGAROO_FOUND, true, thread_note + " finding");
+            check(BN_get_word(x) == vec_value[k], true, thread_note + " DLOG");
+        }
+    }
+
+    // an out-of-range target is given up after KANGAROO_MAX_RETRY walks
+    vector<EC_POINT *> vec_h_out;
+    targets_new(g, {range_size + 12345}, vec_h_out);
+    check(Parallel_Kangaroo_DLOG(x, g, vec_h_out[0], KANGAROO_RANGE_LEN, KANGAROO_TABLE_LEN, 4) == KANGAROO_GIVEN_UP,
+          true, "Kangaroo out-of-range target");
+
+    BN_free(x);
+    ECP_vec_free(vec_h);
+    ECP_vec_free(vec_h_out);
+}
+
+int main()
+{
+    // curve id = NID_secp256k1
+    global_initialize(NID_secp256k1);
+
+    EC_POINT *g = EC_POINT_new(group);
+    EC_POINT_copy(g, generator);
+    string table_file = "test_dlog_" + to_string(getpid()) + ".table";
+    HASHMAP_serialize(g, table_file, RANGE_LEN, TUNNING);
+    HASHMAP_deserialize(table_file, RANGE_LEN, TUNNING);
+
+    test_single(g);
+    test_batch(g);
+    test_generate(g);
+    test_shared(g, table_file);
+    test_degraded(g);
+    test_warmup(g, table_file);
+    test_grow(g, table_file);
+
+    string kangaroo_file = "test_dlog_" + to_string(getpid()) + ".kangaroo";
+    Kangaroo_Table_serialize(g, kangaroo_file, KANGAROO_RANGE_LEN, KANGAROO_TABLE_LEN, 4);
+    Kangaroo_Table_deserialize(g, kangaroo_file, KANGAROO_RANGE_LEN, KANGAROO_TABLE_LEN);
+    test_kangaroo(g);
+
+    remove(table_file.c_str());
+    remove(kangaroo_file.c_str());
+    EC_POINT_free(g);
+    global_finalize();
+
+    if(FAIL_NUM > 0)
+    {
+        cout << FAIL_NUM << " checks failed" << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "all checks passed" << endl;
+    return 0;
+}
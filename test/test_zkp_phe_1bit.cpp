@@ -38,7 +38,7 @@ void test_protocol()
     size_t TUNNING = 7; 
     size_t DEC_THREAD_NUM = 4;
     size_t IO_THREAD_NUM = 4;      
-    Twisted_ElGamal_Setup(pp_tt, MSG_LEN, TUNNING, DEC_THREAD_NUM, IO_THREAD_NUM);
+    Twisted_ElGamal_Setup(pp_tt, MSG_LEN, TUNNING, IO_THREAD_NUM, DEC_THREAD_NUM);
     Twisted_ElGamal_Initialize(pp_tt); 
 
     Twisted_ElGamal_KP keypair;